@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# time the benchmark programs under each set of flags, every -O level by default
+# usage: scripts/bench.sh [ncc] [runs] [flags ...]
+# e.g. generic against host cpu: scripts/bench.sh ./build/release/ncc 5 "-O3" "-O3 -march=native"
+
+ncc=${1:-"./build/release/ncc"}
+runs=${2:-5}
+bench_dir="test/bench"
+configs=("-O0" "-O1" "-O2" "-O3" "-Os")
+if [ $# -gt 2 ]; then
+	configs=("${@:3}")
+fi
+cc=${CC:-cc}
+
+if [ ! -x $ncc ]; then
+	echo "$ncc not found, run ./build.sh release first"
+	exit 1
+fi
+
+out_dir=`mktemp -d`
+trap "rm -rf $out_dir" EXIT
+
+# milliseconds for $runs runs of the binary
+function measure(){
+	local start=`date +%s%N`
+	for ((i = 0; i < $runs; i++))
+	do
+		$1 > /dev/null
+	done
+	local end=`date +%s%N`
+	echo $(((end - start) / 1000000))
+}
+
+printf "%-16s" "program"
+for flags in "${configs[@]}"
+do
+	printf "%24s" "$flags"
+done
+printf "\n"
+
+for source in $bench_dir/*.c
+do
+	name=`basename ${source%.*}`
+	printf "%-16s" $name
+	base=""
+	for flags in "${configs[@]}"
+	do
+		cp $source $out_dir/$name.c
+		$ncc $out_dir/$name.c -t=obj $flags > /dev/null
+		if [ $? -ne 0 ] || [ ! -f $out_dir/$name.o ]; then
+			printf "%24s" "failed"
+			continue
+		fi
+		$cc $out_dir/$name.o -o $out_dir/$name
+		rm -f $out_dir/$name.o
+		time=`measure $out_dir/$name`
+		if [ -z "$base" ]; then
+			base=$time
+		fi
+		# speedup against the first flags
+		speedup=`awk -v b=$base -v t=$time 'BEGIN { if (t == 0) t = 1; printf "%.2fx", b / t }'`
+		printf "%24s" "${time}ms ($speedup)"
+	done
+	printf "\n"
+done
@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# scaling of 'ncc -j N' on a directory of translation units, from 1 to every core
+# usage: scripts/bench_jobs.sh [ncc] [copies] [level]
+
+ncc=${1:-"./build/release/ncc"}
+copies=${2:-16}
+level=${3:-"-O2"}
+cores=`nproc`
+
+if [ ! -x $ncc ]; then
+	echo "$ncc not found, run ./build.sh release first"
+	exit 1
+fi
+
+out_dir=`mktemp -d`
+trap "rm -rf $out_dir" EXIT
+for ((i = 0; i < $copies; i++))
+do
+	for source in test/bench/*.c
+	do
+		cp $source $out_dir/`basename ${source%.*}`_$i.c
+	done
+done
+files=`ls $out_dir/*.c | wc -l`
+
+function now(){
+	date +%s%N
+}
+
+echo "$files files, $level -t=obj"
+base=0
+for ((jobs = 1; jobs <= $cores; jobs *= 2))
+do
+	start=`now`
+	$ncc $level -t=obj -j $jobs $out_dir/*.c > /dev/null
+	time=$((($(now) - start) / 1000000))
+	[ $base -eq 0 ] && base=$time
+	echo "-j $jobs : ${time}ms, x$(echo "scale=2; $base / $time" | bc)"
+done
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# time of one large translation unit with '-fparallel-codegen=N' (the backend)
+# or '-fparallel-irgen=N' (ir generation)
+# usage: scripts/bench_parallel_codegen.sh [ncc] [copies] [level] [flag]
+
+ncc=${1:-"./build/release/ncc"}
+copies=${2:-64}
+level=${3:-"-O2"}
+flag=${4:-"-fparallel-codegen"}
+cores=`nproc`
+
+if [ ! -x $ncc ]; then
+	echo "$ncc not found, run ./build.sh release first"
+	exit 1
+fi
+
+out_dir=`mktemp -d`
+trap "rm -rf $out_dir" EXIT
+# one unit of many renamed copies of the benchmarks
+source=$out_dir/large.c
+for ((i = 0; i < $copies; i++))
+do
+	for bench in test/bench/*.c
+	do
+		sed -e "s/\b\([a-z_][a-z0-9_]*\)\s*(/\1_$i(/g" \
+			-e "s/\b\(if\|for\|while\|return\|switch\|sizeof\)_$i(/\1(/g" $bench >> $source
+	done
+done
+
+function now(){
+	date +%s%N
+}
+
+echo "`grep -c '^[a-z].*)$' $source` functions, $level -t=obj"
+base=0
+for ((parts = 1; parts <= $cores; parts *= 2))
+do
+	start=`now`
+	$ncc $level -t=obj $flag=$parts $source > /dev/null
+	time=$((($(now) - start) / 1000000))
+	[ $base -eq 0 ] && base=$time
+	echo "$flag=$parts : ${time}ms, x$(echo "scale=2; $base / $time" | bc)"
+done
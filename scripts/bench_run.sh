@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# time to the first instruction of main: 'ncc -run', tiered or not, 'ncc -vm', against compile, link and exec
+# usage: scripts/bench_run.sh [ncc] [runs] [source]
+
+ncc=${1:-"./build/release/ncc"}
+runs=${2:-20}
+source=${3:-"test/jit/first.c"}
+cc=${CC:-cc}
+
+if [ ! -x $ncc ]; then
+	echo "$ncc not found, run ./build.sh release first"
+	exit 1
+fi
+
+out_dir=`mktemp -d`
+trap "rm -rf $out_dir" EXIT
+name=`basename ${source%.*}`
+
+function now(){
+	date +%s%N
+}
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	$ncc -run $source > /dev/null
+done
+jit=$((($(now) - start) / 1000 / $runs))
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	$ncc -run -ftiered $source > /dev/null
+done
+tiered=$((($(now) - start) / 1000 / $runs))
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	$ncc -vm $source > /dev/null
+done
+vm=$((($(now) - start) / 1000 / $runs))
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	cp $source $out_dir/$name.c
+	$ncc $out_dir/$name.c -t=obj > /dev/null
+	$cc $out_dir/$name.o -o $out_dir/$name
+	$out_dir/$name > /dev/null
+done
+aot=$((($(now) - start) / 1000 / $runs))
+
+echo "$source, average of $runs runs"
+echo "ncc -run            : ${jit}us"
+echo "ncc -run -ftiered   : ${tiered}us"
+echo "ncc -vm             : ${vm}us"
+echo "ncc -t=obj, cc, exec: ${aot}us"
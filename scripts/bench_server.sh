@@ -0,0 +1,46 @@
+#!/bin/bash
+
+# per-file compile latency: a fresh 'ncc' per file against 'ncc-client' and a warm 'ncc -server'
+# usage: scripts/bench_server.sh [build dir] [runs] [source]
+
+build=${1:-"./build/release"}
+runs=${2:-50}
+source=${3:-"test/bench/fib.c"}
+ncc=$build/ncc
+client=$build/ncc-client
+
+if [ ! -x $ncc ] || [ ! -x $client ]; then
+	echo "$ncc or $client not found, run ./build.sh release first"
+	exit 1
+fi
+
+out_dir=`mktemp -d`
+export NCC_SERVER=$out_dir/ncc.sock
+$ncc -server=$NCC_SERVER 2> /dev/null &
+server=$!
+trap "kill $server; rm -rf $out_dir" EXIT
+cp $source $out_dir/
+source=$out_dir/`basename $source`
+while [ ! -S $NCC_SERVER ]; do sleep 0.1; done
+
+function now(){
+	date +%s%N
+}
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	$ncc -O2 $source -t=obj > /dev/null
+done
+cold=$((($(now) - start) / 1000 / $runs))
+
+start=`now`
+for ((i = 0; i < $runs; i++))
+do
+	$client -O2 $source -t=obj > /dev/null
+done
+warm=$((($(now) - start) / 1000 / $runs))
+
+echo "$source -O2 -t=obj, average of $runs runs"
+echo "ncc        : ${cold}us"
+echo "ncc-client : ${warm}us"
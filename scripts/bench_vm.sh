@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# whole-program time of the bytecode interpreter against the llvm run modes
+# usage: scripts/bench_vm.sh [ncc] [runs] [sources ...]
+
+ncc=${1:-"./build/release/ncc"}
+runs=${2:-5}
+sources=("test/bench/fib.c" "test/bench/factorial.c")
+if [ $# -gt 2 ]; then
+	sources=("${@:3}")
+fi
+modes=("-vm" "-run -ftiered" "-run" "-O2 -run")
+
+if [ ! -x $ncc ]; then
+	echo "$ncc not found, run ./build.sh release first"
+	exit 1
+fi
+
+# milliseconds for $runs runs
+function measure(){
+	local start=`date +%s%N`
+	for ((i = 0; i < $runs; i++))
+	do
+		$ncc $1 $2 > /dev/null
+	done
+	local end=`date +%s%N`
+	echo $(((end - start) / 1000000))
+}
+
+printf "%-16s" "program"
+for mode in "${modes[@]}"
+do
+	printf "%24s" "$mode"
+done
+printf "\n"
+
+for source in "${sources[@]}"
+do
+	printf "%-16s" `basename ${source%.*}`
+	base=""
+	for mode in "${modes[@]}"
+	do
+		time=`measure "$mode" $source`
+		if [ -z "$base" ]; then
+			base=$time
+		fi
+		# speedup against the interpreter
+		speedup=`awk -v b=$base -v t=$time 'BEGIN { if (t == 0) t = 1; printf "%.2fx", b / t }'`
+		printf "%24s" "${time}ms ($speedup)"
+	done
+	printf "\n"
+done
@@ -0,0 +1,42 @@
+#include "alias.h"
+#include <llvm/Config/llvm-config.h>
+#include <llvm/IR/MDBuilder.h>
+
+void ir::AliasScopes::Reset(const std::string &function_name)
+{
+    this->domain = nullptr;
+    this->scopes.clear();
+    this->function_name = function_name;
+}
+llvm::MDNode *ir::AliasScopes::NewScope(const std::string &name)
+{
+    llvm::MDBuilder md(*context);
+    if (!this->domain)
+        this->domain = md.createAnonymousAliasScopeDomain(this->function_name);
+    auto scope = md.createAnonymousAliasScope(this->domain, name);
+    this->scopes.push_back(scope);
+    // inlined into a loop, the cloned scope would hold across iterations. the
+    // declaration tells llvm where it starts, before LLVM 12 the function isn't inlined
+#if LLVM_VERSION_MAJOR >= 12
+    builder->CreateNoAliasScopeDeclaration(llvm::MDNode::get(*context, {scope}));
+#else
+    builder->GetInsertBlock()->getParent()->addFnAttr(llvm::Attribute::NoInline);
+#endif
+    return scope;
+}
+void ir::AliasScopes::Tag(llvm::Value *access, llvm::MDNode *scope)
+{
+    auto inst = llvm::dyn_cast_or_null<llvm::Instruction>(access);
+    if (!inst || !scope)
+        return;
+    // scopes declared later list this one in their own !noalias, that's enough for ScopedNoAliasAA
+    std::vector<llvm::Metadata *> others;
+    for (auto other : this->scopes)
+    {
+        if (other != scope)
+            others.push_back(other);
+    }
+    inst->setMetadata(llvm::LLVMContext::MD_alias_scope, llvm::MDNode::get(*context, {scope}));
+    if (!others.empty())
+        inst->setMetadata(llvm::LLVMContext::MD_noalias, llvm::MDNode::get(*context, others));
+}
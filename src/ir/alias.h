@@ -0,0 +1,25 @@
+#pragma once
+#include "ir.h"
+#include <llvm/IR/Instruction.h>
+#include <llvm/IR/Metadata.h>
+#include <string>
+#include <vector>
+namespace ir
+{
+// scoped noalias metadata for restrict locals: every restrict pointer gets its
+// own scope, an access through it is in that scope and aliases no other one
+class AliasScopes
+{
+private:
+    llvm::MDNode *domain = nullptr;
+    std::string function_name;
+    std::vector<llvm::MDNode *> scopes;
+
+public:
+    void Reset(const std::string &function_name);
+    // a scope that starts here, at the declaration of the restrict pointer
+    llvm::MDNode *NewScope(const std::string &name);
+    // access is based on the restrict pointer of scope
+    void Tag(llvm::Value *access, llvm::MDNode *scope);
+};
+} // namespace ir
\ No newline at end of file
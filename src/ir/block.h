@@ -4,12 +4,14 @@
 #include "type/symbol.h"
 #include <llvm/IR/BasicBlock.h>
 #include <unordered_map>
+#include <vector>
 namespace ir
 {
 class Block
 {
 public:
     std::unordered_map<std::string, std::shared_ptr<ir::Symbol>> SymbolTable;
+    std::vector<llvm::Value *> StackSlots; // allocas live while this scope is
     Block *parent = nullptr;
     Block() = default;
     Block(Block *parent) : parent(parent){};
@@ -21,5 +23,8 @@ public:
     bool HasFunction(const std::string &name);
     bool DefineFunction(std::shared_ptr<ir::FunctionTy> function, const std::string &name);
     std::shared_ptr<ir::FunctionTy> GetFunction(const std::string &name);
+    void LifetimeStart(llvm::Value *slot);
+    void LifetimeEnd();
+    void LifetimeEndAll();
 };
 } // namespace ir
\ No newline at end of file
@@ -4,14 +4,38 @@
 #include "ir.h"
 #include "type/symbol.h"
 #include <functional>
+#include <llvm/ADT/SmallString.h>
 #include <map>
+#include <set>
+#include <vector>
 namespace ir
 {
+// jump targets of the innermost loop
+struct LoopTarget
+{
+    llvm::BasicBlock *break_block;
+    llvm::BasicBlock *continue_block;
+    ir::Block *scope; // block enclosing the loop
+};
 class Generator
 {
 private:
     std::map<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>> generate_code;
     std::map<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>> resolve_symbol;
+    std::vector<ir::LoopTarget> loops;
+    bool GenerateStatement(std::shared_ptr<ast::Node> node, ir::Block &block);
+    bool InitializeArray(std::shared_ptr<ir::Symbol> symbol, std::shared_ptr<ast::Node> list, ir::Block &block, bool zeroed = false);
+    bool GenerateLoop(std::shared_ptr<ast::Node> cond, std::shared_ptr<ast::Node> step,
+                      std::shared_ptr<ast::Node> body, bool test_first, ir::Block &block);
+
+    // '-fparallel-irgen', the definitions whose bodies are lowered here, the others
+    // only declare their prototype. null lowers all of them
+    const std::set<ast::Node *> *bodies = nullptr;
+    bool worker = false; // phase two, the declarations were reported in phase one
+    void Begin(ast::Node *unit);
+    std::vector<std::set<ast::Node *>> Partition(ast::Node *unit, unsigned parts);
+    bool GenerateBodies(std::shared_ptr<ast::Node> &object, const std::vector<std::set<ast::Node *>> &parts);
+    bool GeneratePart(std::shared_ptr<ast::Node> &object, const std::set<ast::Node *> &part, llvm::SmallString<0> &bitcode);
 
 public:
     void Init();
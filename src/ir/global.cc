@@ -1,8 +1,25 @@
 #include "global.h"
 #include "../util/prettyPrint.h"
-ir::Generator generator;
-std::unordered_map<std::string, std::shared_ptr<ir::FunctionTy>> FunctionTable;
-ast::Node *current_node;
+thread_local ir::Generator generator;
+thread_local std::unordered_map<std::string, std::shared_ptr<ir::FunctionTy>> FunctionTable;
+thread_local ast::Node *current_node;
+thread_local ir::SSABuilder ssa_builder;
+thread_local ir::AliasScopes alias_scopes;
+thread_local ir::Options codegen_options;
+thread_local vm::Evaluator const_evaluator;
+llvm::FastMathFlags ir::Options::FastMathFlags()
+{
+    llvm::FastMathFlags res;
+    if (this->fast_math)
+        res.setFast();
+    if (this->no_signed_zeros)
+        res.setNoSignedZeros();
+    if (this->reciprocal_math)
+        res.setAllowReciprocal();
+    if (this->fp_contract == ir::FPContractFast)
+        res.setAllowContract(true);
+    return res;
+}
 void Warning(ast::Node *node, const std::string &info)
 {
     ast::Node *_node = !node ? current_node : node;
@@ -1,11 +1,68 @@
 #pragma once
 #include "../ast/ast.h"
+#include "alias.h"
 #include "generator.h"
 #include "ir.h"
+#include "ssa.h"
+#include "../vm/evaluator.h"
 #include "string"
+#include "vector"
 
-extern ir::Generator generator;
-extern std::unordered_map<std::string, std::shared_ptr<ir::FunctionTy>> FunctionTable;
-extern ast::Node* current_node;
+namespace ir
+{
+// '-ffp-contract=off|on|fast'
+enum FPContract
+{
+    FPContractOff,  // never fuse
+    FPContractOn,   // 'a * b + c' within one expression, as llvm.fmuladd
+    FPContractFast, // anywhere the backend likes
+};
+// '-flto', '-flto=thin'
+enum LTOMode
+{
+    LTONone,
+    LTOFull, // one module of every unit, optimized as a whole
+    LTOThin, // the units stay apart, a summary of each guides imports
+};
+// code generation options from the command line
+struct Options
+{
+    bool wrapv = false;           // '-fwrapv', signed overflow wraps instead of being undefined
+    bool fast_math = false;       // '-ffast-math', implies all below and contract=fast
+    bool no_signed_zeros = false; // '-fno-signed-zeros'
+    bool reciprocal_math = false; // '-freciprocal-math'
+    FPContract fp_contract = FPContractOn;
+    unsigned opt_level = 0;  // '-O0'..'-O3'
+    unsigned size_level = 0; // 1 for '-Os', 2 for '-Oz'
+    std::string cpu = "generic"; // '-march'/'-mcpu', "native" for the host
+    std::string features;        // '-mattr', e.g. "+avx2,-fma"
+    std::string tune_cpu;        // '-mtune', scheduling only
+    std::vector<std::string> multiversion; // '-fmultiversion=avx2,avx512f', a copy per feature
+    std::string profile_generate; // '-fprofile-generate[=dir]', where the .profraw goes
+    std::string profile_use;      // '-fprofile-use=file.profdata'
+    bool ssa = false;             // '-fssa', locals in registers instead of allocas
+    uint64_t constexpr_steps = 1 << 20; // '-fconstexpr-steps', budget of a compile-time call
+    unsigned parallel_codegen = 1; // '-fparallel-codegen=N', parts compiled on N threads
+    bool split_objects = false;    // '-fsplit-objects', keep the parts instead of 'ld -r'
+    unsigned parallel_irgen = 1;   // '-fparallel-irgen=N', function bodies lowered on N threads
+    LTOMode lto = LTONone;         // '-flto[=full|thin]', the units are optimized again as one program
+    std::vector<std::string> exports; // '-fexport=f,g', external after '-flto' next to main
+    unsigned lto_jobs = 0;         // '-flto-jobs=N', threads of the thin backends, 0 for every core
+    std::string lto_cache;         // '-flto-cache=dir', thin backends reused while their inputs match
+    std::string target_triple;   // both set from the target machine before generation,
+    std::string data_layout;     // type sizes in the ir match the object
+
+    llvm::FastMathFlags FastMathFlags();
+};
+} // namespace ir
+
+// the state of a compile belongs to its thread, ncc::CompilerInstance
+extern thread_local ir::Generator generator;
+extern thread_local std::unordered_map<std::string, std::shared_ptr<ir::FunctionTy>> FunctionTable;
+extern thread_local ast::Node* current_node;
+extern thread_local ir::SSABuilder ssa_builder;
+extern thread_local ir::AliasScopes alias_scopes;
+extern thread_local ir::Options codegen_options;
+extern thread_local vm::Evaluator const_evaluator;
 extern void Warning(ast::Node *node, const std::string &info);
 extern void Errors(ast::Node *node, const std::string &info) throw(const char *);
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
+#include "alias.h"
 #include "block.h"
 #include "generator.h"
 #include "global.h"
 #include "ir.h"
+#include "ssa.h"
 #include "type/index.h"
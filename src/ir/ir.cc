@@ -3,18 +3,26 @@
 #include "type/index.h"
 #include <exception>
 #include <iostream>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/raw_os_ostream.h>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <stdlib.h>
+#include <thread>
 
 // [Globals]
-std::unique_ptr<llvm::LLVMContext> context;
-std::unique_ptr<llvm::IRBuilder<>> builder;
-std::unique_ptr<llvm::Module> module;
-std::shared_ptr<ir::FunctionTy> theFunction = nullptr;
+thread_local std::unique_ptr<llvm::LLVMContext> context;
+thread_local std::unique_ptr<llvm::IRBuilder<>> builder;
+thread_local std::unique_ptr<llvm::Module> module;
+thread_local std::shared_ptr<ir::FunctionTy> theFunction = nullptr;
 
 // Assistance
 std::string ScanType(llvm::Type *type)
@@ -56,6 +64,138 @@ void LogType(llvm::Type *type)
 {
     llvm::errs() << ScanType(type) << "\n";
 }
+// fall through to dest, unless the block is already terminated (e.g. return)
+void BranchTo(llvm::BasicBlock *dest)
+{
+    if (!builder->GetInsertBlock()->getTerminator())
+        builder->CreateBr(dest);
+}
+// lower a scalar to the i1 a branch needs, according to its type
+llvm::Value *ConditionValue(std::shared_ptr<ir::Symbol> symbol)
+{
+    auto value = symbol->RValue()->GetValue();
+    auto ty = value->getType();
+    // comparison result, use it as is
+    if (ty->isIntegerTy(1))
+        return value;
+    if (ty->isIntegerTy())
+        return builder->CreateICmpNE(value, llvm::ConstantInt::get(ty, 0), "cond_value");
+    if (ty->isPointerTy())
+        return builder->CreateIsNotNull(value, "cond_value");
+    if (ty->isFloatingPointTy())
+        return builder->CreateFCmpUNE(value, llvm::ConstantFP::get(ty, 0.0), "cond_value");
+    Errors(nullptr, "[ir\\cond] condition must have a scalar type.");
+    return nullptr;
+}
+// branch of if, ?:, && and ||. a compare against zero or null is weighted like
+// llvm's zero heuristic: '==' is rather not taken, '!=' rather taken. anything
+// else, and every branch under '-fprofile-use', is left to llvm's own analysis
+llvm::BranchInst *CondBranch(llvm::Value *cond, llvm::BasicBlock *true_block, llvm::BasicBlock *false_block)
+{
+    llvm::MDNode *weights = nullptr;
+    auto cmp = llvm::dyn_cast<llvm::CmpInst>(cond);
+    auto is_zero = [](llvm::Value *value) {
+        auto constant = llvm::dyn_cast<llvm::Constant>(value);
+        return constant && constant->isNullValue();
+    };
+    if (cmp && codegen_options.profile_use.empty() && (is_zero(cmp->getOperand(0)) || is_zero(cmp->getOperand(1))))
+    {
+        llvm::MDBuilder md(*context);
+        switch (cmp->getPredicate())
+        {
+        case llvm::CmpInst::ICMP_EQ:
+        case llvm::CmpInst::FCMP_OEQ:
+            weights = md.createBranchWeights(12, 20);
+            break;
+        case llvm::CmpInst::ICMP_NE:
+        case llvm::CmpInst::FCMP_UNE:
+            weights = md.createBranchWeights(20, 12);
+            break;
+        default:
+            break;
+        }
+    }
+    return builder->CreateCondBr(cond, true_block, false_block, weights);
+}
+// an expression that can't trap or write anything, and costs at most budget operations
+bool IsCheapPure(ast::Node *node, int &budget)
+{
+    static const std::set<std::string> leaves = {"identifier", "int", "float", "char"};
+    static const std::set<std::string> wrappers = {"expression", "primary_expression"};
+    static const std::set<std::string> operators = {
+        "add_expression", "sub_expression", "mul_expression",
+        "lt_expression", "gt_expression", "le_expression", "ge_expression",
+        "equality_expression", "not_equality_expression"};
+    if (leaves.count(node->type))
+        return true;
+    if (wrappers.count(node->type) && node->children.size() == 1)
+        return IsCheapPure(node->children[0].get(), budget);
+    if (!operators.count(node->type) || --budget < 0)
+        return false;
+    for (auto child : node->children)
+    {
+        if (!IsCheapPure(child.get(), budget))
+            return false;
+    }
+    return true;
+}
+// distinct self-referencing loop id, so the vectorizer and unroller can tell
+// loops apart; loops with a non-constant condition may be assumed to terminate (C11 6.8.5p6)
+llvm::MDNode *LoopMetadata(bool must_progress)
+{
+    llvm::SmallVector<llvm::Metadata *, 2> args;
+    auto temp = llvm::MDNode::getTemporary(*context, llvm::None);
+    args.push_back(temp.get());
+    // llvm.loop.mustprogress is read from LLVM 12, older passes would only carry it
+#if LLVM_VERSION_MAJOR >= 12
+    if (must_progress)
+        args.push_back(llvm::MDNode::get(*context, llvm::MDString::get(*context, "llvm.loop.mustprogress")));
+#endif
+    auto loop_id = llvm::MDNode::getDistinct(*context, args);
+    loop_id->replaceOperandWith(0, loop_id);
+    return loop_id;
+}
+// node: [lhs, rhs], op: one of < > <= >= == !=
+std::shared_ptr<ir::Symbol> CompareSymbol(ast::Node *node,
+                                          std::shared_ptr<ir::Symbol> lhs_symbol,
+                                          std::shared_ptr<ir::Symbol> rhs_symbol,
+                                          const std::string &op)
+{
+    auto best_type = lhs_symbol->type->CastTo(rhs_symbol->type);
+    if (!best_type)
+        best_type = rhs_symbol->type->CastTo(lhs_symbol->type);
+    if (!best_type)
+        Errors(node, "\'compare operator\' : opearnd type not match.");
+    auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->GetValue();
+    auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->GetValue();
+
+    llvm::Value *res = nullptr;
+    auto top = best_type->Top();
+    if (top->type_name == ir::TypeName::Float)
+    {
+        res = op == "<" ? builder->CreateFCmpOLT(lhs_value, rhs_value, "cmp_tmp")
+                        : op == ">" ? builder->CreateFCmpOGT(lhs_value, rhs_value, "cmp_tmp")
+                                    : op == "<=" ? builder->CreateFCmpOLE(lhs_value, rhs_value, "cmp_tmp")
+                                                 : op == ">=" ? builder->CreateFCmpOGE(lhs_value, rhs_value, "cmp_tmp")
+                                                              : op == "==" ? builder->CreateFCmpOEQ(lhs_value, rhs_value, "cmp_tmp")
+                                                                           : builder->CreateFCmpUNE(lhs_value, rhs_value, "cmp_tmp");
+    }
+    else
+    {
+        // pointers compare as unsigned
+        auto i_ty = dynamic_cast<ir::IntegerTy *>(top);
+        bool is_sign = i_ty && i_ty->is_sign;
+        res = op == "<" ? (is_sign ? builder->CreateICmpSLT(lhs_value, rhs_value, "cmp_tmp") : builder->CreateICmpULT(lhs_value, rhs_value, "cmp_tmp"))
+                        : op == ">" ? (is_sign ? builder->CreateICmpSGT(lhs_value, rhs_value, "cmp_tmp") : builder->CreateICmpUGT(lhs_value, rhs_value, "cmp_tmp"))
+                                    : op == "<=" ? (is_sign ? builder->CreateICmpSLE(lhs_value, rhs_value, "cmp_tmp") : builder->CreateICmpULE(lhs_value, rhs_value, "cmp_tmp"))
+                                                 : op == ">=" ? (is_sign ? builder->CreateICmpSGE(lhs_value, rhs_value, "cmp_tmp") : builder->CreateICmpUGE(lhs_value, rhs_value, "cmp_tmp"))
+                                                              : op == "==" ? builder->CreateICmpEQ(lhs_value, rhs_value, "cmp_tmp")
+                                                                           : builder->CreateICmpNE(lhs_value, rhs_value, "cmp_tmp");
+    }
+    // the i1 result feeds a branch directly
+    std::vector<ir::RootType *> bool_stack{ir::IntegerTy::Get(1, false, false)};
+    return ir::Symbol::GetConstant(ir::Type::Get(bool_stack), res);
+}
 // [general] parse type for declaration_specifiers and parameter_declaration
 // node: declaration_specifier
 ir::BaseType *ParseBaseType(ast::Node *node, ir::Block &block)
@@ -124,25 +264,104 @@ ir::BaseType *ParseBaseType(ast::Node *node, ir::Block &block)
     return base_type;
 }
 
-// node: declarator
-std::vector<ir::ReferType *> ParseReferType(ast::Node *node, ir::Block &block)
+// integer constant expression, e.g. an array size
+bool ConstantInteger(ast::Node *node, int64_t &res)
 {
-    std::vector<ir::ReferType *> res;
-    if (node)
+    static const std::set<std::string> wrappers = {"expression", "primary_expression"};
+    if (node->type == "int")
+        return res = atoll(node->value.c_str()), true;
+    if (node->type == "char")
+        return res = node->value.c_str()[1], true;
+    if (wrappers.count(node->type) && node->children.size() == 1)
+        return ConstantInteger(node->children[0].get(), res);
+    // a pure function on constant arguments
+    if (node->type == "function_call" && node->children[0]->type == "identifier")
+    {
+        std::vector<int64_t> args(node->children[1]->children.size());
+        for (size_t i = 0; i < args.size(); ++i)
+        {
+            if (!ConstantInteger(node->children[1]->children[i].get(), args[i]))
+                return false;
+        }
+        return const_evaluator.Call(node->children[0]->value, args, res);
+    }
+    int64_t lhs, rhs;
+    if (node->children.size() != 2 ||
+        !ConstantInteger(node->children[0].get(), lhs) ||
+        !ConstantInteger(node->children[1].get(), rhs))
+        return false;
+    auto &op = node->type;
+    if (op == "add_expression")
+        return res = lhs + rhs, true;
+    if (op == "sub_expression")
+        return res = lhs - rhs, true;
+    if (op == "mul_expression")
+        return res = lhs * rhs, true;
+    if ((op == "div_expression" || op == "mod_expression") && rhs)
+        return res = op == "div_expression" ? lhs / rhs : lhs % rhs, true;
+    return false;
+}
+
+// node: declarator, or a direct_declarator inside it
+// the derived types are pushed from the base outwards, so for 'int *a[2][3]'
+// it's [int] * [3] [2], an array of 2 arrays of 3 pointers
+void ParseDeclarator(ast::Node *node, ir::Block &block, std::vector<ir::RootType *> &types)
+{
+    std::vector<ast::Node *> arrays;
+    ast::Node *inner = nullptr;
+    std::function<void(ast::Node *)> collect = [&](ast::Node *direct) {
+        for (auto child : direct->children)
+        {
+            if (child->type == "direct_declarator")
+                collect(child.get());
+            else if (child->type == "array")
+                arrays.push_back(child.get());
+            // '(' declarator ')'
+            else if (child->type == "declarator")
+                inner = child.get();
+        }
+    };
+    // '*' binds to the base, type_qualifier to the '*' before it
+    for (auto child : node->children)
     {
-        auto &children = node->children;
-        for (auto child : children)
+        if (child->type == "*")
+            types.push_back(ir::PointerTy::Get(types.back(), false));
+        else if (child->type == "type_qualifier" && types.back()->type_name == ir::TypeName::Pointer)
         {
-            auto &type = child->type;
-            auto &value = child->value;
-            // if (type == "declarator")
-            // {
-            // }
-            // else if (type == "*")
-            // {
-            // }
+            auto pointer = (ir::PointerTy *)types.back();
+            types.back() = ir::PointerTy::Get(types[types.size() - 2],
+                                              pointer->is_const || child->value == "const",
+                                              pointer->is_restrict || child->value == "restrict");
         }
     }
+    collect(node);
+    // 'a[2][3]' is an array of 2 arrays of 3
+    for (auto array = arrays.rbegin(); array != arrays.rend(); ++array)
+    {
+        int64_t size = 0;
+        auto &size_expr = (*array)->children;
+        // 'a[]', completed by the initializer or decayed as a parameter
+        if (size_expr.size() && !ConstantInteger(size_expr[0].get(), size))
+            Errors(*array, "[ir\\array] array size is not an integer constant expression.");
+        if (size < 0 || size_expr.size() && !size)
+            Errors(*array, "[ir\\array] array size must be positive.");
+        types.push_back(ir::ArrayTy::Get(types.back(), size, false));
+    }
+    if (inner)
+        ParseDeclarator(inner, block, types);
+}
+
+// node: declarator
+std::vector<ir::ReferType *> ParseReferType(ast::Node *node, ir::BaseType *base_type, ir::Block &block)
+{
+    std::vector<ir::ReferType *> res;
+    if (node && base_type)
+    {
+        std::vector<ir::RootType *> types{base_type};
+        ParseDeclarator(node, block, types);
+        for (auto i = types.begin() + 1; i != types.end(); ++i)
+            res.push_back((ir::ReferType *)*i);
+    }
     return std::move(res);
 }
 
@@ -154,12 +373,144 @@ std::vector<ir::RootType *> ParseFullType(ast::Node *node, ir::Block &block)
     {
         auto base_type = ParseBaseType(node->getNameChild("declaration_specifiers"), block);
         res.push_back(base_type);
-        auto ref_type = ParseReferType(node->getNameChild("declarator"), block);
+        auto ref_type = ParseReferType(node->getNameChild("declarator"), base_type, block);
         res.insert(res.end(), ref_type.begin(), ref_type.end());
     }
     return std::move(res);
 }
 
+// an array parameter is a pointer to its element
+void DecayParameter(std::vector<ir::RootType *> &types)
+{
+    if (types.size() > 1 && types.back()->type_name == ir::TypeName::Array)
+        types.back() = ir::PointerTy::Get(types[types.size() - 2], false);
+}
+
+// signed int arithmetic can't overflow in C, unless '-fwrapv'.
+// narrower types are promoted to int first, so their overflow is a defined truncation
+bool NoSignedWrap(std::shared_ptr<ir::Type> type)
+{
+    auto i_ty = dynamic_cast<ir::IntegerTy *>(type->Top());
+    return i_ty && i_ty->is_sign && i_ty->bits >= 32 && !codegen_options.wrapv;
+}
+
+// '/' and '%' by a constant 2^shift as shifts and masks
+llvm::Value *DivPowerOfTwo(llvm::Value *lhs, unsigned shift, bool is_sign, bool is_rem)
+{
+    auto ty = lhs->getType();
+    auto bits = ty->getIntegerBitWidth();
+    auto mask = llvm::ConstantInt::get(ty, llvm::APInt::getLowBitsSet(bits, shift));
+    if (!is_sign)
+        return is_rem ? builder->CreateAnd(lhs, mask, "urem_pow2") : builder->CreateLShr(lhs, shift, "udiv_pow2");
+    // signed division rounds towards zero, so bias a negative lhs by 2^shift - 1
+    auto bias = shift ? builder->CreateLShr(builder->CreateAShr(lhs, bits - 1), bits - shift, "div_bias") : nullptr;
+    auto biased = bias ? builder->CreateAdd(lhs, bias, "div_biased") : lhs;
+    if (!is_rem)
+        return shift ? builder->CreateAShr(biased, shift, "sdiv_pow2") : lhs;
+    // lhs - (biased & ~mask)
+    return builder->CreateSub(lhs, builder->CreateAnd(biased, builder->CreateNot(mask)), "srem_pow2");
+}
+
+// unwrap parentheses
+ast::Node *StripParen(ast::Node *node)
+{
+    while ((node->type == "expression" || node->type == "primary_expression") && node->children.size() == 1)
+        node = node->children[0].get();
+    return node;
+}
+
+// 'a * b + c' in one expression as llvm.fmuladd, the backend fuses it where the target has fma.
+// only the product of the operand expression itself, contraction never crosses statements
+llvm::Value *FuseMulAdd(ast::Node *lhs_node, llvm::Value *lhs, ast::Node *rhs_node, llvm::Value *rhs, bool is_sub)
+{
+    if (codegen_options.fp_contract != ir::FPContractOn)
+        return nullptr;
+    auto as_fmul = [](ast::Node *node, llvm::Value *value) -> llvm::BinaryOperator * {
+        auto mul = llvm::dyn_cast<llvm::BinaryOperator>(value);
+        if (StripParen(node)->type != "mul_expression" || !mul || mul->getOpcode() != llvm::Instruction::FMul || !mul->use_empty())
+            return nullptr;
+        return mul;
+    };
+    auto mul = as_fmul(lhs_node, lhs);
+    auto addend = rhs;
+    bool negate_mul = false;
+    if (!mul)
+    {
+        mul = as_fmul(rhs_node, rhs);
+        addend = lhs;
+        negate_mul = is_sub;
+    }
+    if (!mul)
+        return nullptr;
+    auto mul_lhs = mul->getOperand(0);
+    if (negate_mul)
+        mul_lhs = builder->CreateFNeg(mul_lhs);
+    else if (is_sub)
+        addend = builder->CreateFNeg(addend);
+    auto fmuladd = llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::fmuladd, {mul->getType()});
+    auto res = builder->CreateCall(fmuladd, {mul_lhs, mul->getOperand(1), addend}, "fmuladd");
+    mul->eraseFromParent();
+    return res;
+}
+
+// integer '/' or '%', by the signedness of type
+llvm::Value *IntDivRem(std::shared_ptr<ir::Type> type, llvm::Value *lhs, llvm::Value *rhs, bool is_rem)
+{
+    auto i_ty = dynamic_cast<ir::IntegerTy *>(type->Top());
+    bool is_sign = !i_ty || i_ty->is_sign;
+    auto rhs_const = llvm::dyn_cast<llvm::ConstantInt>(rhs);
+    if (rhs_const && rhs_const->getValue().isPowerOf2() && !(is_sign && rhs_const->isNegative()))
+        return DivPowerOfTwo(lhs, rhs_const->getValue().logBase2(), is_sign, is_rem);
+    if (is_rem)
+        return is_sign ? builder->CreateSRem(lhs, rhs) : builder->CreateURem(lhs, rhs);
+    return is_sign ? builder->CreateSDiv(lhs, rhs) : builder->CreateUDiv(lhs, rhs);
+}
+
+// subscript or pointer offset, as the i64 a gep takes
+llvm::Value *IndexValue(ast::Node *node, std::shared_ptr<ir::Symbol> symbol)
+{
+    auto index = symbol->RValue();
+    auto i_ty = dynamic_cast<ir::IntegerTy *>(index->type->Top());
+    if (!i_ty)
+        Errors(node, "[ir\\index] array subscript or pointer offset is not an integer.");
+    return builder->CreateIntCast(index->GetValue(), builder->getInt64Ty(), i_ty->is_sign, "idx_ext");
+}
+
+// 'p + n', 'n + p', 'p - n' as an inbounds gep, 'p - q' as the element distance
+std::shared_ptr<ir::Symbol> PointerArith(ast::Node *node, std::shared_ptr<ir::Symbol> lhs_symbol, std::shared_ptr<ir::Symbol> rhs_symbol, bool is_sub)
+{
+    auto lhs = lhs_symbol->RValue();
+    auto rhs = rhs_symbol->RValue();
+    bool lhs_ptr = lhs->type->Top()->type_name == ir::TypeName::Pointer;
+    bool rhs_ptr = rhs->type->Top()->type_name == ir::TypeName::Pointer;
+    if (lhs_ptr && rhs_ptr)
+    {
+        if (!is_sub || lhs->type->Top()->_ty != rhs->type->Top()->_ty)
+            Errors(node, "[ir\\ptr-arith] invalid operands to pointer arithmetic.");
+        std::vector<ir::RootType *> long_stack{ir::IntegerTy::Get(64, true, false)};
+        auto pointee_ty = lhs->type->Top()->_ty->getPointerElementType();
+        auto elem_size = module->getDataLayout().getTypeAllocSize(pointee_ty);
+        auto lhs_int = builder->CreatePtrToInt(lhs->GetValue(), builder->getInt64Ty());
+        auto rhs_int = builder->CreatePtrToInt(rhs->GetValue(), builder->getInt64Ty());
+        auto diff = builder->CreateExactSDiv(builder->CreateSub(lhs_int, rhs_int), builder->getInt64(elem_size), "ptr_diff");
+        return ir::Symbol::GetConstant(ir::Type::Get(long_stack), diff);
+    }
+    if (!lhs_ptr && (is_sub || !rhs_ptr))
+        Errors(node, "[ir\\ptr-arith] invalid operands to pointer arithmetic.");
+    auto pointer = lhs_ptr ? lhs : rhs;
+    auto offset = IndexValue(node, lhs_ptr ? rhs : lhs);
+    if (is_sub)
+        offset = builder->CreateNeg(offset, "idx_neg");
+    auto pointee = std::make_shared<ir::Type>(*pointer->type);
+    pointee->DeReference();
+    if (pointee->Top()->type_name == ir::TypeName::Void)
+        Errors(node, "[ir\\ptr-arith] arithmetic on a \'void *\'.");
+    auto res = builder->CreateInBoundsGEP(pointee->Top()->_ty, pointer->GetValue(), offset, "ptr_add");
+    auto res_symbol = ir::Symbol::GetConstant(pointer->type, res);
+    res_symbol->restrict_scope = pointer->restrict_scope;
+    return res_symbol;
+}
+
 // [Generator]
 void ir::Generator::Init()
 {
@@ -173,12 +524,17 @@ void ir::Generator::Init()
             current_node = node.get();
             for (auto child : node->children)
             {
-                if (child->type == "expression")
-                {
-                    if (!resolve_symbol.at("expression")(child, block))
-                        return false;
-                }
-                else if (!generate_code.at(child->type)(child, block))
+                // a worker of '-fparallel-irgen' goes through the declarations again, quietly
+                auto out = pretty::out, err = pretty::err;
+                std::ostringstream repeated;
+                if (this->worker && !this->bodies->count(child.get()))
+                    pretty::out = pretty::err = &repeated;
+                bool res = child->type == "expression"
+                               ? resolve_symbol.at("expression")(child, block) != nullptr
+                               : generate_code.at(child->type)(child, block);
+                pretty::out = out;
+                pretty::err = err;
+                if (!res)
                     return false;
             }
             return true;
@@ -257,7 +613,7 @@ void ir::Generator::Init()
             {
                 // don't care id
                 auto type_stack = ParseFullType(para_decl.get(), block);
-                auto base_type = dynamic_cast<ir::BaseType *>(type_stack[0]);
+                DecayParameter(type_stack);
                 auto full_type = ir::Type::Get(type_stack);
                 if (is_void_para)
                     Errors(decl.get(), "[ir\\fun-def] \'void\' must be the first and only parameter if specified.");
@@ -267,14 +623,16 @@ void ir::Generator::Init()
                 }
                 else
                 {
+                    auto para_id = para_decl->getNameChild("identifier");
                     para_type_list.push_back(full_type);
-                    para_type.push_back(base_type->_ty);
+                    para_type.push_back(full_type->Top()->_ty);
+                    para_name.push_back(para_id ? para_id->value : "");
                 }
             }
 
             // create function prototype
             llvm::FunctionType *function_type =
-                llvm::FunctionType::get(ret_type->BaseTy()->_ty, para_type, false);
+                llvm::FunctionType::get(ret_type->Top()->_ty, para_type, false);
             // check if exists a same name but different type function, which should be error
             auto maybe_fun = module->getFunction(fun_name);
             if (maybe_fun)
@@ -290,10 +648,23 @@ void ir::Generator::Init()
                     module.get());
             if (!function || !function_type)
                 Errors(decl.get(), "[ir\\fun-def\\llvm] can't create function.");
+            // let the backend know, the fast-math flags only reach the ir instructions
+            if (codegen_options.fast_math)
+            {
+                function->addFnAttr("unsafe-fp-math", "true");
+                function->addFnAttr("no-infs-fp-math", "true");
+                function->addFnAttr("no-nans-fp-math", "true");
+            }
+            if (codegen_options.fast_math || codegen_options.no_signed_zeros)
+                function->addFnAttr("no-signed-zeros-fp-math", "true");
             // set parameter name
             unsigned idx = 0;
             for (auto &arg : function->args())
             {
+                // a restrict parameter is the only way to its pointee
+                auto para_ptr = dynamic_cast<ir::PointerTy *>(para_type_list[idx]->Top());
+                if (para_ptr && para_ptr->is_restrict)
+                    arg.addAttr(llvm::Attribute::NoAlias);
                 arg.setName(para_name[idx++]);
             }
             if (!function)
@@ -328,6 +699,9 @@ void ir::Generator::Init()
             {
                 Errors(decl.get(), "[ir\\fun_def] function name conflicts with an already exists symbol/function.");
             }
+            // '-fparallel-irgen', the body is lowered on another thread
+            if (this->bodies && !this->bodies->count(node.get()))
+                return true;
 
             // compound statements
             auto comp_stat = func_decl->children[2];
@@ -340,6 +714,9 @@ void ir::Generator::Init()
             auto comp_bb = llvm::BasicBlock::Create(*context, fun_name + "_block", function);
             auto old_bb = builder->GetInsertBlock();
             builder->SetInsertPoint(comp_bb);
+            ssa_builder.Reset(comp_stat.get());
+            ssa_builder.SealBlock(comp_bb);
+            alias_scopes.Reset(fun_name);
             //  create symbols for parameters
             idx = 0;
             for (auto arg = function->arg_begin(); arg != function->arg_end(); ++arg)
@@ -361,10 +738,22 @@ void ir::Generator::Init()
                 Errors(comp_stat.get(), "[ir\\fun-def] fail to generate statements block.");
 
             // if ret_type is void, llvm needs a handful return expr
-            if (ret_type->Top()->type_name == ir::TypeName::Void)
+            comp_block.LifetimeEnd();
+            if (ret_type->Top()->type_name == ir::TypeName::Void && !builder->GetInsertBlock()->getTerminator())
             {
                 builder->CreateRetVoid();
             }
+            // blocks control never reaches the end of, e.g. the exit of 'while (1)' or the
+            // merge of an if/else whose arms both return
+            for (auto &bb : *function)
+            {
+                if (!bb.getTerminator())
+                {
+                    builder->SetInsertPoint(&bb);
+                    builder->CreateUnreachable();
+                }
+            }
+            ssa_builder.Finish();
             builder->SetInsertPoint(old_bb);
             theFunction = old_fun;
 
@@ -373,11 +762,11 @@ void ir::Generator::Init()
             llvm::raw_string_ostream es(err_str);
             bool function_broken = llvm::verifyFunction(*function, &es);
             es.flush();
-            std::cout << "\n[generator] function verification result: "
+            *pretty::out << "\n[generator] function verification result: "
                       << (function_broken ? "wrong" : "correct") << std::endl;
             if (function_broken)
             {
-                std::cout << "[ir] Errors message:\n"
+                *pretty::out << "[ir] Errors message:\n"
                           << err_str << std::endl;
                 return false;
             }
@@ -428,7 +817,7 @@ void ir::Generator::Init()
                     {
                         // don't care id
                         auto type_stack = ParseFullType(para_decl.get(), block);
-                        auto base_type = dynamic_cast<ir::BaseType *>(type_stack[0]);
+                        DecayParameter(type_stack);
                         auto full_type = ir::Type::Get(type_stack);
                         if (is_void_para)
                             Errors(decl.get(), "[ir\\fun-def] \'void\' must be the first and only parameter if specified.");
@@ -439,14 +828,14 @@ void ir::Generator::Init()
                         else
                         {
                             para_type_list.push_back(full_type);
-                            para_type.push_back(base_type->_ty);
+                            para_type.push_back(full_type->Top()->_ty);
                         }
                     }
                 }
 
                 // create function prototype
                 llvm::FunctionType *function_type =
-                    llvm::FunctionType::get(ret_type->BaseTy()->_ty, para_type, false);
+                    llvm::FunctionType::get(ret_type->Top()->_ty, para_type, false);
                 // check if exists a same name but different type function, which should be error
                 auto maybe_fun = module->getFunction(fun_name);
                 if (maybe_fun)
@@ -495,32 +884,54 @@ void ir::Generator::Init()
                 auto init_decl_list = node->children[1];
                 for (auto child : init_decl_list->children)
                 {
-                    // [not implement] 'pointer' yet
-                    // [not implement] 'array' yet
                     auto &id_name = child->getNameChild("identifier")->value;
                     auto declarator = child->getNameChild("declarator");
-                    auto ref_stack = ParseReferType(declarator, block);
+                    auto ref_stack = ParseReferType(declarator, base_type, block);
                     std::vector<ir::RootType *> type_stack;
                     type_stack.push_back(base_type);
                     type_stack.insert(type_stack.end(), ref_stack.begin(), ref_stack.end());
+                    auto init_list = child->type == "init_declarator" && child->children[1]->type == "initializer_list"
+                                         ? child->children[1]
+                                         : nullptr;
+                    // 'int a[] = {...}' takes its size from the initializer
+                    auto array_ty = dynamic_cast<ir::ArrayTy *>(type_stack.back());
+                    if (array_ty && !array_ty->size)
+                    {
+                        if (!init_list)
+                            Errors(child.get(), "[ir\\decl] array size missing in \'" + id_name + "\'.");
+                        type_stack.back() = ir::ArrayTy::Get(type_stack[type_stack.size() - 2], init_list->children.size(), false);
+                    }
                     auto full_type = ir::Type::Get(type_stack);
                     auto symbol = ir::Symbol::Get(full_type, id_name);
-
-                    if (child->type == "init_declarator")
+                    block.LifetimeStart(symbol->GetValue());
+                    // restrict locals of the function body get their own alias scope; the body runs
+                    // once per call, a nested block may run repeatedly and the scope wouldn't hold
+                    auto pointer_ty = dynamic_cast<ir::PointerTy *>(full_type->Top());
+                    if (pointer_ty && pointer_ty->is_restrict && block.parent && !block.parent->parent)
+                        symbol->restrict_scope = alias_scopes.NewScope(id_name);
+
+                    if (init_list)
+                    {
+                        if (!array_ty)
+                            Errors(child.get(), "[ir\\decl] initializer list for a non-array symbol.");
+                        if (!this->InitializeArray(symbol, init_list, block))
+                            return false;
+                    }
+                    else if (child->type == "init_declarator")
                     {
-                        // can be initializer_list or expression
-                        // [not implement] 'initializer_list' for array
                         auto expr = child->children[1];
                         auto assign_symbol = resolve_symbol.at(expr->type)(expr, block);
                         if (!assign_symbol)
                             return false;
                         auto assign_value = assign_symbol->RValue();
+                        // the type is shared, restore its qualifier afterwards
+                        auto was_const = symbol->type->Top()->is_const;
                         symbol->type->Top()->is_const = false;
                         if (!symbol->Assign(assign_value))
                         {
                             Errors(child.get(), "[ir\\decl] can't store value to symbol.");
                         }
-                        symbol->type->Top()->is_const = true;
+                        symbol->type->Top()->is_const = was_const;
                     }
                     // if it's a const symbol, but not initialize, it's error
                     else if (symbol->type->Top()->is_const)
@@ -554,14 +965,7 @@ void ir::Generator::Init()
             auto cond_symbol = resolve_symbol.at("expression")(expr, block);
             if (!cond_symbol)
                 return false;
-            auto cond_tmp = cond_symbol->RValue()->CastTo(ir::FloatTy::Get(32, false));
-            auto cond_value = cond_tmp->GetValue();
-
-            // bool <- float
-            cond_value = builder->CreateFCmpONE(
-                cond_value,
-                llvm::ConstantFP::get(*context, llvm::APFloat(0.0f)),
-                "cond-value");
+            auto cond_value = ConditionValue(cond_symbol);
             llvm::Function *block_fun = builder->GetInsertBlock()->getParent();
             // then block
             llvm::BasicBlock *true_block = llvm::BasicBlock::Create(
@@ -577,19 +981,20 @@ void ir::Generator::Init()
                 *context,
                 llvm::Twine("merge_block"));
 
-            builder->CreateCondBr(cond_value,
-                                  true_block,
-                                  false_block);
+            CondBranch(cond_value, true_block, false_block);
+            ssa_builder.SealBlock(true_block);
+            ssa_builder.SealBlock(false_block);
 
             // Emit then llvm::Value.
             auto true_stat = children[1];
             ir::Block true_b(&block);
             auto old_bb = builder->GetInsertBlock();
             builder->SetInsertPoint(true_block);
-            if (!generate_code.at("compound_statement")(true_stat, true_b))
+            if (!this->GenerateStatement(true_stat, true_b))
                 return false;
 
-            builder->CreateBr(merge_block);
+            true_b.LifetimeEnd();
+            BranchTo(merge_block);
             // Codegen of 'Then' can change the current block, update ThenBB for the PHI.
             true_block = builder->GetInsertBlock();
             builder->SetInsertPoint(old_bb);
@@ -603,10 +1008,11 @@ void ir::Generator::Init()
                 ir::Block false_b(&block);
                 old_bb = builder->GetInsertBlock();
                 builder->SetInsertPoint(false_block);
-                if (!generate_code.at("compound_statement")(false_stat, false_b))
+                if (!this->GenerateStatement(false_stat, false_b))
                     return false;
 
-                builder->CreateBr(merge_block);
+                false_b.LifetimeEnd();
+                BranchTo(merge_block);
                 // Codegen of 'Else' can change the current block, update ElseBB for the PHI.
                 false_block = builder->GetInsertBlock();
                 builder->SetInsertPoint(old_bb);
@@ -615,6 +1021,7 @@ void ir::Generator::Init()
             // Emit merge block.
             block_fun->getBasicBlockList().push_back(merge_block);
             builder->SetInsertPoint(merge_block);
+            ssa_builder.SealBlock(merge_block);
             return true;
         }));
 
@@ -628,22 +1035,16 @@ void ir::Generator::Init()
             auto cond_symbol = resolve_symbol.at("expression")(expr, block);
             if (!cond_symbol)
                 return false;
-            auto cond_tmp = cond_symbol->RValue()->CastTo(ir::FloatTy::Get(32, false));
-            auto cond_value = cond_tmp->GetValue();
-            if (cond_tmp->type->Top()->is_const)
+            auto cond_value = ConditionValue(cond_symbol);
+            // constant condition, only the taken branch is generated
+            if (auto cond_const = llvm::dyn_cast<llvm::ConstantInt>(cond_value))
             {
                 auto true_stat = children[1];
-                if (!generate_code.at("compound_statement")(true_stat, block))
+                if (!cond_const->isZero() && !this->GenerateStatement(true_stat, block))
                     return false;
             }
             else
             {
-
-                // bool <- float
-                cond_value = builder->CreateFCmpONE(
-                    cond_value,
-                    llvm::ConstantFP::get(*context, llvm::APFloat(0.0f)),
-                    "cond-value");
                 llvm::Function *block_fun = builder->GetInsertBlock()->getParent();
                 // then block
                 llvm::BasicBlock *true_block = llvm::BasicBlock::Create(
@@ -655,19 +1056,19 @@ void ir::Generator::Init()
                     *context,
                     llvm::Twine("merge_block"));
 
-                builder->CreateCondBr(cond_value,
-                                      true_block,
-                                      merge_block);
+                CondBranch(cond_value, true_block, merge_block);
+                ssa_builder.SealBlock(true_block);
 
                 // Emit then llvm::Value.
                 auto true_stat = children[1];
                 ir::Block true_b(&block);
                 auto old_bb = builder->GetInsertBlock();
                 builder->SetInsertPoint(true_block);
-                if (!generate_code.at("compound_statement")(true_stat, true_b))
+                if (!this->GenerateStatement(true_stat, true_b))
                     return false;
 
-                builder->CreateBr(merge_block);
+                true_b.LifetimeEnd();
+                BranchTo(merge_block);
                 // Codegen of 'Then' can change the current block, update ThenBB for the PHI.
                 true_block = builder->GetInsertBlock();
                 builder->SetInsertPoint(old_bb);
@@ -675,9 +1076,76 @@ void ir::Generator::Init()
                 // Emit merge block.
                 block_fun->getBasicBlockList().push_back(merge_block);
                 builder->SetInsertPoint(merge_block);
+                ssa_builder.SealBlock(merge_block);
             }
             return true;
         }));
+    // [loop]
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "while_statement",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            current_node = node.get();
+            auto &children = node->children;
+            return this->GenerateLoop(children[0], nullptr, children[1], true, block);
+        }));
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "do_statement",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            current_node = node.get();
+            auto &children = node->children;
+            return this->GenerateLoop(children[1], nullptr, children[0], false, block);
+        }));
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "for_statement",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            current_node = node.get();
+            // node: [init, cond, (step), body], init and cond may be an empty expression_statement
+            auto &children = node->children;
+            auto init = children[0];
+            auto cond = children[1]->type == "expression_statement" ? nullptr : children[1];
+            auto step = children.size() == 4 ? children[2] : nullptr;
+            if (!this->GenerateStatement(init, block))
+                return false;
+            return this->GenerateLoop(cond, step, children.back(), true, block);
+        }));
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "break",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            current_node = node.get();
+            if (this->loops.empty())
+                Errors(node.get(), "[ir\\break] \'break\' statement not in loop statement.");
+            auto &loop = this->loops.back();
+            for (auto scope = &block; scope && scope != loop.scope; scope = scope->parent)
+                scope->LifetimeEnd();
+            BranchTo(loop.break_block);
+            // anything following is unreachable
+            auto dead_block = llvm::BasicBlock::Create(*context, "break_dead", builder->GetInsertBlock()->getParent());
+            builder->SetInsertPoint(dead_block);
+            ssa_builder.SealBlock(dead_block);
+            return true;
+        }));
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "continue",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            current_node = node.get();
+            if (this->loops.empty())
+                Errors(node.get(), "[ir\\continue] \'continue\' statement not in loop statement.");
+            auto &loop = this->loops.back();
+            for (auto scope = &block; scope && scope != loop.scope; scope = scope->parent)
+                scope->LifetimeEnd();
+            BranchTo(loop.continue_block);
+            auto dead_block = llvm::BasicBlock::Create(*context, "continue_dead", builder->GetInsertBlock()->getParent());
+            builder->SetInsertPoint(dead_block);
+            ssa_builder.SealBlock(dead_block);
+            return true;
+        }));
+    // ';'
+    generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "expression_statement",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> bool {
+            return true;
+        }));
+
     // [return]
     generate_code.insert(std::pair<std::string, std::function<bool(std::shared_ptr<ast::Node>, ir::Block &)>>(
         "return_expr",
@@ -696,6 +1164,7 @@ void ir::Generator::Init()
             auto ret_value = ret_symbol->RValue()->CastTo(theFunction->ret_type->Top())->RValue();
             if (!ret_value)
                 Errors(expr_node.get(), "[ir\\ret] return value not match required type.");
+            block.LifetimeEndAll();
             if (!builder->CreateRet(ret_value->GetValue()))
                 Errors(expr_node.get(), "[ir\\ret] can't create return instruction.");
             return true;
@@ -710,6 +1179,7 @@ void ir::Generator::Init()
             {
                 Errors(node.get(), "[ir\\ret] needs return value here.");
             }
+            block.LifetimeEndAll();
             builder->CreateRetVoid();
             return true;
         }));
@@ -799,7 +1269,26 @@ void ir::Generator::Init()
                 }
             }
 
-            auto ret_val = builder->CreateCall(fun, arg_list, "call_" + fun_name);
+            // a pure function on constant arguments runs now, once, instead of at every call.
+            // only when optimizing, the registers don't wrap like 32 bit '-fwrapv' math
+            auto ret_ty = fun->getReturnType();
+            if (codegen_options.opt_level && !codegen_options.wrapv && ret_ty->isIntegerTy())
+            {
+                std::vector<int64_t> args;
+                for (unsigned i = 0; i < arg_list.size(); ++i)
+                {
+                    auto arg = llvm::dyn_cast<llvm::ConstantInt>(arg_list[i]);
+                    auto arg_ty = dynamic_cast<ir::IntegerTy *>(symbol_list[i]->type->Top());
+                    if (!arg || !arg_ty)
+                        break;
+                    args.push_back(arg_ty->is_sign && arg_ty->bits > 1 ? arg->getSExtValue() : arg->getZExtValue());
+                }
+                int64_t res;
+                if (args.size() == arg_list.size() && const_evaluator.Call(fun_name, args, res))
+                    return ir::Symbol::GetConstant(ret_type, llvm::ConstantInt::get(ret_ty, res, true));
+            }
+            // a void value can't have a name
+            auto ret_val = builder->CreateCall(fun, arg_list, ret_ty->isVoidTy() ? "" : "call_" + fun_name);
             return ir::Symbol::GetConstant(ret_type, ret_val);
         }));
 
@@ -812,6 +1301,20 @@ void ir::Generator::Init()
             auto child = node->children[0];
             return resolve_symbol.at(child->type)(child, block);
         }));
+    // 'a, b', the operands left to right, the value is the last one's
+    resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "comma_expression",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+            current_node = node.get();
+            std::shared_ptr<ir::Symbol> symbol;
+            for (auto child : node->children)
+            {
+                symbol = resolve_symbol.at(child->type)(child, block);
+                if (!symbol)
+                    return nullptr;
+            }
+            return symbol;
+        }));
     resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
         "primary_expression",
         [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
@@ -871,6 +1374,9 @@ void ir::Generator::Init()
             auto rhs_node = node->children[1];
             auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
 
+            if (!lhs_symbol->type->_tys.empty() || !rhs_symbol->type->_tys.empty())
+                return PointerArith(node.get(), lhs_symbol, rhs_symbol, false);
+
             // [not implement] predict the best type
             auto best_type = lhs_symbol->type->CastTo(rhs_symbol->type);
             if (!best_type)
@@ -880,29 +1386,16 @@ void ir::Generator::Init()
             auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
             auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
 
-            auto res_symbol = ir::Symbol::Get(best_type, "add_result");
-            auto tmp_symbol = ir::Symbol::Get(best_type, "add_tmp");
-            // tmp_symbol has to hold a int
-            // auto int_or_ptr = builder->CreateAdd(lhs_symbol->RValue()->GetValue(), rhs_symbol->RValue()->GetValue());
-
-            auto int_or_ptr = best_type->_bty->type_name == ir::TypeName::Float
-                                  ? builder->CreateFAdd(lhs_value, rhs_value)
-                                  : builder->CreateAdd(lhs_value, rhs_value);
-
-            // // if createAdd returns a int*
-            // tmp_symbol->Store(builder->CreateLoad(int_or_ptr));
-
-            // if createAdd return a int
-            tmp_symbol->Store(int_or_ptr);
-
-            // if assign failure
-            res_symbol->type->Top()->is_const = false;
-            if (!res_symbol->Assign(tmp_symbol))
+            llvm::Value *res = nullptr;
+            if (best_type->_bty->type_name == ir::TypeName::Float)
             {
-                return nullptr;
+                res = FuseMulAdd(lhs_node.get(), lhs_value, rhs_node.get(), rhs_value, false);
+                if (!res)
+                    res = builder->CreateFAdd(lhs_value, rhs_value);
             }
-            res_symbol->type->Top()->is_const = true;
-            return res_symbol->RValue();
+            else
+                res = builder->CreateAdd(lhs_value, rhs_value, "", false, NoSignedWrap(best_type));
+            return ir::Symbol::GetConstant(best_type, res);
         }));
     resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
         "sub_expression",
@@ -914,6 +1407,9 @@ void ir::Generator::Init()
             auto rhs_node = node->children[1];
             auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
 
+            if (!lhs_symbol->type->_tys.empty() || !rhs_symbol->type->_tys.empty())
+                return PointerArith(node.get(), lhs_symbol, rhs_symbol, true);
+
             // [not implement] predict the best type
             auto best_type = lhs_symbol->type->CastTo(rhs_symbol->type);
             if (!best_type)
@@ -923,27 +1419,16 @@ void ir::Generator::Init()
             auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
             auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
 
-            auto res_symbol = ir::Symbol::Get(best_type, "sub_result");
-            auto tmp_symbol = ir::Symbol::Get(best_type, "sub_tmp");
-            // tmp_symbol has to hold a int
-            auto int_or_ptr = best_type->_bty->type_name == ir::TypeName::Float
-                                  ? builder->CreateFSub(lhs_value, rhs_value)
-                                  : builder->CreateSub(lhs_value, rhs_value);
-
-            // // if createAdd returns a int*
-            // tmp_symbol->Store(builder->CreateLoad(int_or_ptr));
-
-            // if createAdd return a int
-            tmp_symbol->Store(int_or_ptr);
-
-            // if assign failure
-            res_symbol->type->Top()->is_const = false;
-            if (!res_symbol->Assign(tmp_symbol))
+            llvm::Value *res = nullptr;
+            if (best_type->_bty->type_name == ir::TypeName::Float)
             {
-                return nullptr;
+                res = FuseMulAdd(lhs_node.get(), lhs_value, rhs_node.get(), rhs_value, true);
+                if (!res)
+                    res = builder->CreateFSub(lhs_value, rhs_value);
             }
-            res_symbol->type->Top()->is_const = true;
-            return res_symbol->RValue();
+            else
+                res = builder->CreateSub(lhs_value, rhs_value, "", false, NoSignedWrap(best_type));
+            return ir::Symbol::GetConstant(best_type, res);
         }));
     resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
         "mul_expression",
@@ -964,30 +1449,36 @@ void ir::Generator::Init()
             auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
             auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
 
-            auto res_symbol = ir::Symbol::Get(best_type, "mul_result");
-            auto tmp_symbol = ir::Symbol::Get(best_type, "mul_tmp");
-            // tmp_symbol has to hold a int
-
-            auto int_or_ptr = best_type->_bty->type_name == ir::TypeName::Float
-                                  ? builder->CreateFMul(lhs_value, rhs_value)
-                                  : builder->CreateMul(lhs_value, rhs_value);
-            // // if createAdd returns a int*
-            // tmp_symbol->Store(builder->CreateLoad(int_or_ptr));
+            auto res = best_type->_bty->type_name == ir::TypeName::Float
+                           ? builder->CreateFMul(lhs_value, rhs_value)
+                           : builder->CreateMul(lhs_value, rhs_value, "", false, NoSignedWrap(best_type));
+            return ir::Symbol::GetConstant(best_type, res);
+        }));
+    resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "div_expression",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+            current_node = node.get();
+            auto lhs_node = node->children[0];
+            auto lhs_symbol = resolve_symbol.at(lhs_node->type)(lhs_node, block);
 
-            // if createAdd return a int
-            tmp_symbol->Store(int_or_ptr);
+            auto rhs_node = node->children[1];
+            auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
 
-            // if assign failure
-            res_symbol->type->Top()->is_const = false;
-            if (!res_symbol->Assign(tmp_symbol))
-            {
-                return nullptr;
-            }
-            res_symbol->type->Top()->is_const = true;
-            return res_symbol->RValue();
+            // [not implement] predict the best type
+            auto best_type = lhs_symbol->type->CastTo(rhs_symbol->type);
+            if (!best_type)
+                best_type = rhs_symbol->type->CastTo(lhs_symbol->type);
+            if (!best_type)
+                Errors(node.get(), "\'binary operator\' : opearnd type not match.");
+            auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
+            auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
+            auto res = best_type->_bty->type_name == ir::TypeName::Float
+                           ? builder->CreateFDiv(lhs_value, rhs_value)
+                           : IntDivRem(best_type, lhs_value, rhs_value, false);
+            return ir::Symbol::GetConstant(best_type, res);
         }));
     resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
-        "div_expression",
+        "mod_expression",
         [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
             current_node = node.get();
             auto lhs_node = node->children[0];
@@ -1002,32 +1493,403 @@ void ir::Generator::Init()
                 best_type = rhs_symbol->type->CastTo(lhs_symbol->type);
             if (!best_type)
                 Errors(node.get(), "\'binary operator\' : opearnd type not match.");
+            if (best_type->_bty->type_name == ir::TypeName::Float)
+                Errors(node.get(), "\'%\' : invalid operands of floating type.");
             auto lhs_value = lhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
             auto rhs_value = rhs_symbol->RValue()->CastTo(best_type->Top())->RValue()->GetValue();
-            auto res_symbol = ir::Symbol::Get(best_type, "div_result");
-            auto tmp_symbol = ir::Symbol::Get(best_type, "div_tmp");
-            // tmp_symbol has to hold a int
-            auto int_or_ptr = best_type->_bty->type_name == ir::TypeName::Float
-                                  ? builder->CreateFDiv(lhs_value, rhs_value)
-                                  : builder->CreateSDiv(lhs_value, rhs_value);
-
-            // // if createAdd returns a int*
-            // tmp_symbol->Store(builder->CreateLoad(int_or_ptr));
-
-            // if createAdd return a int
-            tmp_symbol->Store(int_or_ptr);
-
-            // if assign failure
-            res_symbol->type->Top()->is_const = false;
-            if (!res_symbol->Assign(tmp_symbol))
+            auto res = IntDivRem(best_type, lhs_value, rhs_value, true);
+            return ir::Symbol::GetConstant(best_type, res);
+        }));
+
+    // [pointer]
+    resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "index_reference",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+            current_node = node.get();
+            // node: [postfix_expression, '[', expression, ']']
+            auto base_node = node->children[0];
+            auto base_symbol = resolve_symbol.at(base_node->type)(base_node, block);
+            if (!base_symbol)
+                return nullptr;
+            auto index_node = node->children[2];
+            auto index_symbol = resolve_symbol.at(index_node->type)(index_node, block);
+            if (!index_symbol)
+                return nullptr;
+            auto index = IndexValue(node.get(), index_symbol);
+
+            auto top = base_symbol->type->Top();
+            auto elem_type = std::make_shared<ir::Type>(*base_symbol->type);
+            llvm::Value *address = nullptr;
+            llvm::MDNode *access_scope = nullptr;
+            // index into the array object itself, so 'a[i][j]' stays one gep chain over [n x [m x T]]
+            if (top->type_name == ir::TypeName::Array && base_symbol->is_lvalue)
             {
+                elem_type->DeReference();
+                address = builder->CreateInBoundsGEP(top->_ty, base_symbol->GetValue(), {builder->getInt64(0), index}, "array_idx");
+                access_scope = base_symbol->access_scope;
+            }
+            else if (top->type_name == ir::TypeName::Pointer)
+            {
+                elem_type->DeReference();
+                if (elem_type->Top()->type_name == ir::TypeName::Void)
+                    Errors(node.get(), "[ir\\index] subscript of a \'void *\'.");
+                auto pointer = base_symbol->RValue();
+                address = builder->CreateInBoundsGEP(elem_type->Top()->_ty, pointer->GetValue(), index, "ptr_idx");
+                access_scope = pointer->restrict_scope;
+            }
+            else
+                Errors(node.get(), "[ir\\index] subscripted value is not an array or pointer.");
+            auto res = ir::Symbol::GetReference(elem_type, address);
+            res->access_scope = access_scope;
+            return res;
+        }));
+    resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "unary_operator",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+            current_node = node.get();
+            // node: [op, cast_expression]
+            auto &op = node->children[0]->value;
+            auto operand_node = node->children[1];
+            auto operand = resolve_symbol.at(operand_node->type)(operand_node, block);
+            if (!operand)
+                return nullptr;
+            if (op == "&")
+                return operand->Reference();
+            if (op == "*")
+                return operand->DeReference();
+            // [not implement] '+', '-', '~', '!'
+            Errors(node.get(), "[ir\\unary] operator \'" + op + "\' is not implemented.");
+            return nullptr;
+        }));
+
+    // [compare]
+    std::vector<std::pair<std::string, std::string>> compare_ops = {
+        {"lt_expression", "<"},
+        {"gt_expression", ">"},
+        {"le_expression", "<="},
+        {"ge_expression", ">="},
+        {"equality_expression", "=="},
+        {"not_equality_expression", "!="}};
+    for (auto &compare_op : compare_ops)
+    {
+        auto op = compare_op.second;
+        resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+            compare_op.first,
+            [&, op](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+                current_node = node.get();
+                auto lhs_node = node->children[0];
+                auto lhs_symbol = resolve_symbol.at(lhs_node->type)(lhs_node, block);
+                if (!lhs_symbol)
+                    return nullptr;
+
+                auto rhs_node = node->children[1];
+                auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
+                if (!rhs_symbol)
+                    return nullptr;
+                return CompareSymbol(node.get(), lhs_symbol, rhs_symbol, op);
+            }));
+    }
+
+    // [logical]
+    // short circuit: the rhs is only evaluated when the lhs doesn't decide
+    std::vector<std::pair<std::string, bool>> logical_ops = {
+        {"logical_and_expression", true},
+        {"logical_or_expression", false}};
+    for (auto &logical_op : logical_ops)
+    {
+        auto is_and = logical_op.second;
+        resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+            logical_op.first,
+            [&, is_and](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+                current_node = node.get();
+                std::vector<ir::RootType *> bool_stack{ir::IntegerTy::Get(1, false, false)};
+                auto bool_type = ir::Type::Get(bool_stack);
+
+                auto lhs_node = node->children[0];
+                auto lhs_symbol = resolve_symbol.at(lhs_node->type)(lhs_node, block);
+                if (!lhs_symbol)
+                    return nullptr;
+                auto lhs_cond = ConditionValue(lhs_symbol);
+
+                auto rhs_node = node->children[1];
+                // the lhs is known, fold
+                if (auto lhs_const = llvm::dyn_cast<llvm::ConstantInt>(lhs_cond))
+                {
+                    if (lhs_const->isZero() == is_and)
+                        return ir::Symbol::GetConstant(bool_type, lhs_cond);
+                    auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
+                    if (!rhs_symbol)
+                        return nullptr;
+                    return ir::Symbol::GetConstant(bool_type, ConditionValue(rhs_symbol));
+                }
+
+                llvm::Function *block_fun = builder->GetInsertBlock()->getParent();
+                auto lhs_block = builder->GetInsertBlock();
+                auto rhs_block = llvm::BasicBlock::Create(*context, is_and ? "land_rhs" : "lor_rhs", block_fun);
+                auto merge_block = llvm::BasicBlock::Create(*context, is_and ? "land_end" : "lor_end");
+                if (is_and)
+                    CondBranch(lhs_cond, rhs_block, merge_block);
+                else
+                    CondBranch(lhs_cond, merge_block, rhs_block);
+                ssa_builder.SealBlock(rhs_block);
+
+                builder->SetInsertPoint(rhs_block);
+                auto rhs_symbol = resolve_symbol.at(rhs_node->type)(rhs_node, block);
+                if (!rhs_symbol)
+                    return nullptr;
+                auto rhs_cond = ConditionValue(rhs_symbol);
+                // rhs codegen can change the current block
+                rhs_block = builder->GetInsertBlock();
+                builder->CreateBr(merge_block);
+
+                block_fun->getBasicBlockList().push_back(merge_block);
+                builder->SetInsertPoint(merge_block);
+                ssa_builder.SealBlock(merge_block);
+                auto phi = builder->CreatePHI(builder->getInt1Ty(), 2, is_and ? "land_tmp" : "lor_tmp");
+                phi->addIncoming(is_and ? builder->getFalse() : builder->getTrue(), lhs_block);
+                phi->addIncoming(rhs_cond, rhs_block);
+                return ir::Symbol::GetConstant(bool_type, phi);
+            }));
+    }
+
+    // [conditional]
+    resolve_symbol.insert(std::pair<std::string, std::function<std::shared_ptr<ir::Symbol>(std::shared_ptr<ast::Node>, ir::Block &)>>(
+        "conditional_expression",
+        [&](std::shared_ptr<ast::Node> node, ir::Block &block) -> std::shared_ptr<ir::Symbol> {
+            current_node = node.get();
+            auto cond_node = node->children[0];
+            auto true_node = node->children[1];
+            auto false_node = node->children[2];
+
+            auto cond_symbol = resolve_symbol.at(cond_node->type)(cond_node, block);
+            if (!cond_symbol)
                 return nullptr;
+            auto cond_value = ConditionValue(cond_symbol);
+
+            // the condition is known, only one arm is evaluated
+            if (auto cond_const = llvm::dyn_cast<llvm::ConstantInt>(cond_value))
+            {
+                auto arm_node = cond_const->isZero() ? false_node : true_node;
+                auto arm_symbol = resolve_symbol.at(arm_node->type)(arm_node, block);
+                return arm_symbol ? arm_symbol->RValue() : nullptr;
+            }
+
+            // both arms are cheap and can't trap, evaluate both and select
+            int budget = 4;
+            if (IsCheapPure(true_node.get(), budget) && IsCheapPure(false_node.get(), budget))
+            {
+                auto true_symbol = resolve_symbol.at(true_node->type)(true_node, block);
+                auto false_symbol = resolve_symbol.at(false_node->type)(false_node, block);
+                if (!true_symbol || !false_symbol)
+                    return nullptr;
+                auto best_type = true_symbol->type->CastTo(false_symbol->type);
+                if (!best_type)
+                    best_type = false_symbol->type->CastTo(true_symbol->type);
+                if (!best_type)
+                    Errors(node.get(), "\'?:\' : opearnd type not match.");
+                auto true_value = true_symbol->RValue()->CastTo(best_type->Top())->GetValue();
+                auto false_value = false_symbol->RValue()->CastTo(best_type->Top())->GetValue();
+                return ir::Symbol::GetConstant(best_type, builder->CreateSelect(cond_value, true_value, false_value, "cond_tmp"));
             }
-            res_symbol->type->Top()->is_const = true;
-            return res_symbol->RValue();
+
+            llvm::Function *block_fun = builder->GetInsertBlock()->getParent();
+            auto true_block = llvm::BasicBlock::Create(*context, "cond_true", block_fun);
+            auto false_block = llvm::BasicBlock::Create(*context, "cond_false", block_fun);
+            auto merge_block = llvm::BasicBlock::Create(*context, "cond_end");
+            CondBranch(cond_value, true_block, false_block);
+            ssa_builder.SealBlock(true_block);
+            ssa_builder.SealBlock(false_block);
+
+            // arms are left open until the common type is known
+            builder->SetInsertPoint(true_block);
+            auto true_symbol = resolve_symbol.at(true_node->type)(true_node, block);
+            if (!true_symbol)
+                return nullptr;
+            true_symbol = true_symbol->RValue();
+            true_block = builder->GetInsertBlock();
+
+            builder->SetInsertPoint(false_block);
+            auto false_symbol = resolve_symbol.at(false_node->type)(false_node, block);
+            if (!false_symbol)
+                return nullptr;
+            false_symbol = false_symbol->RValue();
+            false_block = builder->GetInsertBlock();
+
+            auto best_type = true_symbol->type->CastTo(false_symbol->type);
+            if (!best_type)
+                best_type = false_symbol->type->CastTo(true_symbol->type);
+            if (!best_type || best_type->Top()->type_name == ir::TypeName::Void)
+                Errors(node.get(), "\'?:\' : opearnd type not match.");
+
+            builder->SetInsertPoint(true_block);
+            auto true_value = true_symbol->CastTo(best_type->Top())->GetValue();
+            builder->CreateBr(merge_block);
+            builder->SetInsertPoint(false_block);
+            auto false_value = false_symbol->CastTo(best_type->Top())->GetValue();
+            builder->CreateBr(merge_block);
+
+            block_fun->getBasicBlockList().push_back(merge_block);
+            builder->SetInsertPoint(merge_block);
+            ssa_builder.SealBlock(merge_block);
+            auto phi = builder->CreatePHI(true_value->getType(), 2, "cond_tmp");
+            phi->addIncoming(true_value, true_block);
+            phi->addIncoming(false_value, false_block);
+            return ir::Symbol::GetConstant(best_type, phi);
         }));
 }
 
+// number of scalars in an initializer_list
+uint64_t InitializerCount(ast::Node *list)
+{
+    if (list->type != "initializer_list")
+        return 1;
+    uint64_t res = 0;
+    for (auto child : list->children)
+        res += InitializerCount(child.get());
+    return res;
+}
+
+// '{...}' for an array symbol, missing elements are zero
+bool ir::Generator::InitializeArray(std::shared_ptr<ir::Symbol> symbol, std::shared_ptr<ast::Node> list, ir::Block &block, bool zeroed)
+{
+    auto array_ty = dynamic_cast<ir::ArrayTy *>(symbol->type->Top());
+    auto address = symbol->GetValue();
+    auto elem_type = std::make_shared<ir::Type>(*symbol->type);
+    elem_type->DeReference();
+    bool is_nested = elem_type->Top()->type_name == ir::TypeName::Array;
+    if (list->children.size() > array_ty->size)
+        Errors(list.get(), "[ir\\array] excess elements in array initializer.");
+    // a partial initializer zeroes the whole object once, rather than element by element
+    uint64_t elem_count = 1;
+    auto &tys = symbol->type->_tys;
+    for (auto ty = tys.rbegin(); ty != tys.rend() && (*ty)->type_name == ir::TypeName::Array; ++ty)
+        elem_count *= ((ir::ArrayTy *)*ty)->size;
+    if (!zeroed && InitializerCount(list.get()) < elem_count)
+    {
+        zeroed = true;
+        auto &layout = module->getDataLayout();
+        builder->CreateMemSet(address, builder->getInt8(0), layout.getTypeAllocSize(array_ty->_ty),
+#if LLVM_VERSION_MAJOR >= 10
+                              llvm::MaybeAlign(layout.getABITypeAlignment(array_ty->_ty)));
+#else
+                              layout.getABITypeAlignment(array_ty->_ty));
+#endif
+    }
+    for (unsigned i = 0; i < list->children.size(); ++i)
+    {
+        auto init = list->children[i];
+        auto elem_address = builder->CreateInBoundsGEP(array_ty->_ty, address, {builder->getInt64(0), builder->getInt64(i)}, "array_init");
+        auto elem = ir::Symbol::GetReference(elem_type, elem_address);
+        if (is_nested)
+        {
+            if (init->type != "initializer_list")
+                Errors(init.get(), "[ir\\array] expect \'{\' to initialize a sub array.");
+            if (!this->InitializeArray(elem, init, block, zeroed))
+                return false;
+            continue;
+        }
+        if (init->type == "initializer_list")
+            Errors(init.get(), "[ir\\array] too many braces around scalar initializer.");
+        auto init_symbol = this->resolve_symbol.at(init->type)(init, block);
+        if (!init_symbol)
+            return false;
+        // an initialization, so const elements are fine
+        auto value = init_symbol->RValue();
+        if (elem_type->_tys.empty())
+            value = value->CastTo(elem_type->Top());
+        elem->Store(value->GetValue());
+    }
+    return true;
+}
+
+// a statement of any kind, e.g. the body of if or while
+bool ir::Generator::GenerateStatement(std::shared_ptr<ast::Node> node, ir::Block &block)
+{
+    if (node->type == "expression" || node->type == "comma_expression")
+        return this->resolve_symbol.at(node->type)(node, block) != nullptr;
+    return this->generate_code.at(node->type)(node, block);
+}
+
+// canonical loop: preheader -> header -> body -> latch -> header, leaving to exit.
+// 'break' goes to exit, 'continue' to the latch, so the latch holds the only back edge.
+// test_first is false for do-while, whose body is the header and whose latch tests.
+bool ir::Generator::GenerateLoop(std::shared_ptr<ast::Node> cond, std::shared_ptr<ast::Node> step,
+                                 std::shared_ptr<ast::Node> body, bool test_first, ir::Block &block)
+{
+    auto &resolve_symbol = this->resolve_symbol;
+    llvm::Function *block_fun = builder->GetInsertBlock()->getParent();
+    auto header_block = llvm::BasicBlock::Create(*context, "loop_header", block_fun);
+    auto body_block = test_first ? llvm::BasicBlock::Create(*context, "loop_body") : header_block;
+    auto latch_block = llvm::BasicBlock::Create(*context, "loop_latch");
+    auto exit_block = llvm::BasicBlock::Create(*context, "loop_end");
+
+    // the current block is the preheader
+    BranchTo(header_block);
+    builder->SetInsertPoint(header_block);
+
+    // the loop branches carry no weights, llvm's loop heuristics keep the body hot
+    bool must_progress = true;
+    if (test_first)
+    {
+        // 'for (;;)' has no condition
+        llvm::Value *cond_value = builder->getTrue();
+        if (cond)
+        {
+            // 'expression' or 'comma_expression'
+            auto cond_symbol = resolve_symbol.at(cond->type)(cond, block);
+            if (!cond_symbol)
+                return false;
+            cond_value = ConditionValue(cond_symbol);
+        }
+        if (auto cond_const = llvm::dyn_cast<llvm::ConstantInt>(cond_value))
+        {
+            must_progress = false;
+            builder->CreateBr(cond_const->isZero() ? exit_block : body_block);
+        }
+        else
+            builder->CreateCondBr(cond_value, body_block, exit_block);
+        block_fun->getBasicBlockList().push_back(body_block);
+        builder->SetInsertPoint(body_block);
+        ssa_builder.SealBlock(body_block);
+    }
+
+    // body
+    this->loops.push_back({exit_block, latch_block, &block});
+    ir::Block body_b(&block);
+    if (!this->GenerateStatement(body, body_b))
+        return false;
+    body_b.LifetimeEnd();
+    this->loops.pop_back();
+    BranchTo(latch_block);
+
+    // latch, all 'continue' are known now
+    block_fun->getBasicBlockList().push_back(latch_block);
+    builder->SetInsertPoint(latch_block);
+    ssa_builder.SealBlock(latch_block);
+    if (step && !resolve_symbol.at(step->type)(step, block))
+        return false;
+    llvm::BranchInst *back_edge = nullptr;
+    if (test_first)
+        back_edge = builder->CreateBr(header_block);
+    else
+    {
+        auto cond_symbol = resolve_symbol.at(cond->type)(cond, block);
+        if (!cond_symbol)
+            return false;
+        auto cond_value = ConditionValue(cond_symbol);
+        must_progress = !llvm::isa<llvm::Constant>(cond_value);
+        back_edge = builder->CreateCondBr(cond_value, header_block, exit_block);
+    }
+    back_edge->setMetadata(llvm::LLVMContext::MD_loop, LoopMetadata(must_progress));
+    ssa_builder.SealBlock(header_block);
+
+    // exit, all 'break' are known now
+    block_fun->getBasicBlockList().push_back(exit_block);
+    builder->SetInsertPoint(exit_block);
+    ssa_builder.SealBlock(exit_block);
+    return true;
+}
+
 bool ir::Generator::Generate(std::shared_ptr<ast::Node> &object)
 {
     auto &generate_code = this->generate_code;
@@ -1035,10 +1897,8 @@ bool ir::Generator::Generate(std::shared_ptr<ast::Node> &object)
     {
         // Main loop
         // Create infrastructure
-        ir::CreateIrUnit();
+        this->Begin(object.get());
         ir::Block global;
-        current_node = nullptr;
-        FunctionTable.clear();
         auto &root = object;
         auto &type = root->type;
         if (type != "translation_unit")
@@ -1046,8 +1906,23 @@ bool ir::Generator::Generate(std::shared_ptr<ast::Node> &object)
             Errors(root.get(), "Ast root has to be a translation_unit.");
         }
 
+        // '-fparallel-irgen=N', phase one declares everything here, the bodies come
+        // from N threads
+        std::vector<std::set<ast::Node *>> parts;
+        std::set<ast::Node *> none;
+        if (codegen_options.parallel_irgen > 1)
+            parts = this->Partition(root.get(), codegen_options.parallel_irgen);
+        if (parts.size() > 1)
+            this->bodies = &none;
+
         // Generate ir from a tree
-        if (!generate_code.at("translation_unit")(root, global))
+        auto generated = generate_code.at("translation_unit")(root, global);
+        this->bodies = nullptr;
+        if (!generated)
+        {
+            Errors(root.get(), "");
+        }
+        if (parts.size() > 1 && !this->GenerateBodies(root, parts))
         {
             Errors(root.get(), "");
         }
@@ -1057,7 +1932,7 @@ bool ir::Generator::Generate(std::shared_ptr<ast::Node> &object)
         llvm::raw_string_ostream es(err_str);
         bool module_broken = llvm::verifyModule(*module, &es);
         es.flush();
-        std::cout << "\n[ir] module verification result: "
+        *pretty::out << "\n[ir] module verification result: "
                   << (module_broken ? "wrong" : "correct") << std::endl;
         if (module_broken)
         {
@@ -1073,20 +1948,139 @@ bool ir::Generator::Generate(std::shared_ptr<ast::Node> &object)
     }
     catch (const char *error)
     {
+        this->bodies = nullptr;
         // if an ast errors when generating IR
-        module->print(llvm::errs(), nullptr); // print error msg
-        std::cout << "[IR-Errors] IR-Generation is pasued due to previous error.\n"
+        llvm::raw_os_ostream err_stream(*pretty::err);
+        module->print(err_stream, nullptr); // print error msg
+        err_stream.flush();
+        *pretty::out << "[IR-Errors] IR-Generation is pasued due to previous error.\n"
                   << error << "\n";
         return false;
     }
 }
 
+// a fresh module for unit on this thread
+void ir::Generator::Begin(ast::Node *unit)
+{
+    ir::CreateIrUnit();
+    current_node = nullptr;
+    FunctionTable.clear();
+    this->loops.clear();
+    ssa_builder.enabled = codegen_options.ssa;
+    const_evaluator.steps = codegen_options.constexpr_steps;
+    const_evaluator.Reset(unit);
+}
+// the function definitions in contiguous runs of about the same size, the linked
+// module keeps them in source order
+std::vector<std::set<ast::Node *>> ir::Generator::Partition(ast::Node *unit, unsigned parts)
+{
+    std::vector<ast::Node *> definitions;
+    for (auto &child : unit->children)
+    {
+        if (child->type == "function_definition")
+            definitions.push_back(child.get());
+    }
+    std::vector<std::set<ast::Node *>> res(std::min<size_t>(parts, definitions.size()));
+    for (size_t i = 0; i < definitions.size(); ++i)
+        res[i * res.size() / definitions.size()].insert(definitions[i]);
+    return res;
+}
+// phase two, a context for every part on a thread of its own. contexts can't be
+// shared, the parts come back as bitcode and are linked into the module of phase one
+bool ir::Generator::GenerateBodies(std::shared_ptr<ast::Node> &object, const std::vector<std::set<ast::Node *>> &parts)
+{
+    auto options = codegen_options;
+    auto file = pretty::file;
+    auto source = pretty::source;
+    std::vector<llvm::SmallString<0>> bitcodes(parts.size());
+    std::vector<std::string> outs(parts.size()), errs(parts.size());
+    std::vector<char> failed(parts.size(), 0);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        workers.emplace_back([&, i] {
+            codegen_options = options;
+            pretty::file = file;
+            pretty::source = source;
+            std::ostringstream out, err;
+            pretty::out = &out;
+            pretty::err = &err;
+            failed[i] = !generator.GeneratePart(object, parts[i], bitcodes[i]);
+            outs[i] = out.str();
+            errs[i] = err.str();
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+
+    // the messages as if the bodies were lowered one after another
+    bool res = true;
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        *pretty::out << outs[i];
+        *pretty::err << errs[i];
+        if (failed[i])
+            res = false;
+    }
+    for (size_t i = 0; res && i < parts.size(); ++i)
+    {
+        auto part = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcodes[i].str(), "part"), *context);
+        if (!part)
+        {
+            *pretty::err << llvm::toString(part.takeError()) << std::endl;
+            return false;
+        }
+        if (llvm::Linker::linkModules(*module, std::move(*part)))
+            return false;
+    }
+    return res;
+}
+// on a worker, the declarations of the unit and the bodies of part into bitcode
+bool ir::Generator::GeneratePart(std::shared_ptr<ast::Node> &object, const std::set<ast::Node *> &part, llvm::SmallString<0> &bitcode)
+{
+    try
+    {
+        this->Begin(object.get());
+        ir::Block global;
+        this->bodies = &part;
+        this->worker = true;
+        auto res = this->generate_code.at("translation_unit")(object, global);
+        this->bodies = nullptr;
+        this->worker = false;
+        if (!res)
+            return false;
+        llvm::raw_svector_ostream stream(bitcode);
+#if LLVM_VERSION_MAJOR >= 7
+        llvm::WriteBitcodeToFile(*module, stream);
+#else
+        llvm::WriteBitcodeToFile(module.get(), stream);
+#endif
+        return true;
+    }
+    catch (const char *error)
+    {
+        this->bodies = nullptr;
+        this->worker = false;
+        return false;
+    }
+}
+
 // [IR]
 void ir::CreateIrUnit()
 {
+    // the module and the builder of the unit before go ahead of their context
+    builder.reset();
+    module.reset();
     context = llvm::make_unique<llvm::LLVMContext>();
+    // the cached types belong to the context before
+    ir::ClearTypes();
     builder = llvm::make_unique<llvm::IRBuilder<>>(*context);
+    builder->setFastMathFlags(codegen_options.FastMathFlags());
     module = llvm::make_unique<llvm::Module>("my JIT", *context);
+    if (!codegen_options.target_triple.empty())
+        module->setTargetTriple(codegen_options.target_triple);
+    if (!codegen_options.data_layout.empty())
+        module->setDataLayout(codegen_options.data_layout);
 }
 
 // [Block]
@@ -1162,4 +2156,30 @@ std::shared_ptr<ir::FunctionTy> ir::Block::GetFunction(const std::string &name)
     return this->HasFunction(name)
                ? FunctionTable.at(name)
                : nullptr;
+}
+void ir::Block::LifetimeStart(llvm::Value *slot)
+{
+    if (!slot || !llvm::isa<llvm::AllocaInst>(slot) || !builder->GetInsertBlock())
+        return;
+    builder->CreateLifetimeStart(slot);
+    this->StackSlots.push_back(slot);
+}
+// leave this scope
+void ir::Block::LifetimeEnd()
+{
+    auto bb = builder->GetInsertBlock();
+    if (!bb || bb->getTerminator())
+        return;
+    for (auto slot = this->StackSlots.rbegin(); slot != this->StackSlots.rend(); ++slot)
+    {
+        builder->CreateLifetimeEnd(*slot);
+    }
+}
+// leave this scope and all enclosing ones, e.g. at return
+void ir::Block::LifetimeEndAll()
+{
+    for (auto block = this; block; block = block->parent)
+    {
+        block->LifetimeEnd();
+    }
 }
\ No newline at end of file
@@ -6,10 +6,10 @@
 #include <llvm/IR/Module.h>
 #include <memory>
 
-// globals
-extern std::unique_ptr<llvm::LLVMContext> context;
-extern std::unique_ptr<llvm::IRBuilder<>> builder;
-extern std::unique_ptr<llvm::Module> module;
+// globals, one compile per thread
+extern thread_local std::unique_ptr<llvm::LLVMContext> context;
+extern thread_local std::unique_ptr<llvm::IRBuilder<>> builder;
+extern thread_local std::unique_ptr<llvm::Module> module;
 namespace ir
 {
 void CreateIrUnit();
@@ -0,0 +1,153 @@
+#include "ssa.h"
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/ValueHandle.h>
+
+void ir::SSABuilder::Reset(ast::Node *function_body)
+{
+    this->variables.clear();
+    this->current_def.clear();
+    this->incomplete_phis.clear();
+    this->sealed_blocks.clear();
+    this->address_taken.clear();
+    this->active = this->enabled;
+    if (!this->active || !function_body)
+        return;
+    // symbols under '&' must stay in memory
+    for (auto op : function_body->getNameChildren("unary_operator"))
+    {
+        if (op->children.size() == 2 && op->children[0]->value == "&")
+        {
+            for (auto id : op->children[1]->getNameChildren("identifier"))
+                this->address_taken.insert(id->value);
+        }
+    }
+}
+void ir::SSABuilder::Finish()
+{
+    this->active = false;
+    this->current_def.clear();
+    this->incomplete_phis.clear();
+    this->sealed_blocks.clear();
+}
+bool ir::SSABuilder::Promotable(const std::string &name, llvm::Type *type)
+{
+    if (!this->active || !type || this->address_taken.count(name))
+        return false;
+    return type->isIntegerTy() || type->isFloatingPointTy() || type->isPointerTy();
+}
+unsigned ir::SSABuilder::NewVariable(llvm::Type *type, const std::string &name)
+{
+    this->variables.push_back({type, name});
+    return this->variables.size() - 1;
+}
+void ir::SSABuilder::WriteVariable(unsigned var, llvm::BasicBlock *block, llvm::Value *value)
+{
+    this->current_def[block][var] = value;
+}
+llvm::Value *ir::SSABuilder::ReadVariable(unsigned var, llvm::BasicBlock *block)
+{
+    auto &defs = this->current_def[block];
+    auto def = defs.find(var);
+    if (def != defs.end())
+        return def->second;
+    return this->ReadVariableRecursive(var, block);
+}
+void ir::SSABuilder::SealBlock(llvm::BasicBlock *block)
+{
+    if (this->sealed_blocks.count(block))
+        return;
+    auto phis = this->incomplete_phis[block];
+    this->incomplete_phis.erase(block);
+    for (auto &item : phis)
+        this->AddPhiOperands(item.first, item.second);
+    this->sealed_blocks.insert(block);
+}
+
+llvm::PHINode *ir::SSABuilder::CreatePhi(unsigned var, llvm::BasicBlock *block)
+{
+    auto &variable = this->variables[var];
+    if (block->empty())
+        return llvm::PHINode::Create(variable.type, 0, variable.name, block);
+    return llvm::PHINode::Create(variable.type, 0, variable.name, &block->front());
+}
+llvm::Value *ir::SSABuilder::ReadVariableRecursive(unsigned var, llvm::BasicBlock *block)
+{
+    llvm::Value *val = nullptr;
+    if (!this->sealed_blocks.count(block))
+    {
+        // predecessors not known yet, fill the phi when sealing
+        auto phi = this->CreatePhi(var, block);
+        this->incomplete_phis[block][var] = phi;
+        val = phi;
+    }
+    else if (llvm::pred_empty(block))
+    {
+        // read before any definition
+        val = llvm::UndefValue::get(this->variables[var].type);
+    }
+    else if (auto pred = block->getUniquePredecessor())
+    {
+        val = this->ReadVariable(var, pred);
+    }
+    else
+    {
+        // break cycles with an operandless phi
+        auto phi = this->CreatePhi(var, block);
+        this->WriteVariable(var, block, phi);
+        val = this->AddPhiOperands(var, phi);
+    }
+    this->WriteVariable(var, block, val);
+    return val;
+}
+llvm::Value *ir::SSABuilder::AddPhiOperands(unsigned var, llvm::PHINode *phi)
+{
+    auto block = phi->getParent();
+    for (auto pred : llvm::predecessors(block))
+    {
+        phi->addIncoming(this->ReadVariable(var, pred), pred);
+    }
+    return this->TryRemoveTrivialPhi(phi);
+}
+llvm::Value *ir::SSABuilder::TryRemoveTrivialPhi(llvm::PHINode *phi)
+{
+    llvm::Value *same = nullptr;
+    for (auto &op : phi->incoming_values())
+    {
+        auto val = op.get();
+        if (val == same || val == phi)
+            continue;
+        // merges at least two values, not trivial
+        if (same)
+            return phi;
+        same = val;
+    }
+    if (!same)
+        same = llvm::UndefValue::get(phi->getType());
+
+    std::vector<llvm::WeakTrackingVH> users;
+    for (auto user : phi->users())
+    {
+        if (user != phi && llvm::isa<llvm::PHINode>(user))
+            users.emplace_back(user);
+    }
+    phi->replaceAllUsesWith(same);
+    for (auto &defs : this->current_def)
+    {
+        for (auto &def : defs.second)
+        {
+            if (def.second == phi)
+                def.second = same;
+        }
+    }
+    phi->eraseFromParent();
+
+    // users may have become trivial, skip the ones still waiting for operands
+    for (auto &user : users)
+    {
+        auto user_phi = llvm::dyn_cast_or_null<llvm::PHINode>(user);
+        if (user_phi && user_phi->getNumIncomingValues())
+            this->TryRemoveTrivialPhi(user_phi);
+    }
+    return same;
+}
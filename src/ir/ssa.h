@@ -0,0 +1,46 @@
+#pragma once
+#include "../ast/ast.h"
+#include "ir.h"
+#include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/Instructions.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+namespace ir
+{
+// on-the-fly ssa construction for scalar locals (Braun et al.),
+// symbols that never have their address taken live in registers
+class SSABuilder
+{
+private:
+    struct Variable
+    {
+        llvm::Type *type;
+        std::string name;
+    };
+    std::vector<Variable> variables;
+    std::map<llvm::BasicBlock *, std::map<unsigned, llvm::Value *>> current_def;
+    std::map<llvm::BasicBlock *, std::map<unsigned, llvm::PHINode *>> incomplete_phis;
+    std::set<llvm::BasicBlock *> sealed_blocks;
+    std::set<std::string> address_taken;
+
+    llvm::PHINode *CreatePhi(unsigned var, llvm::BasicBlock *block);
+    llvm::Value *ReadVariableRecursive(unsigned var, llvm::BasicBlock *block);
+    llvm::Value *AddPhiOperands(unsigned var, llvm::PHINode *phi);
+    llvm::Value *TryRemoveTrivialPhi(llvm::PHINode *phi);
+
+public:
+    bool enabled = false; // '-fssa', from the options of the compile
+    bool active = false;  // only inside a function body
+
+    void Reset(ast::Node *function_body);
+    void Finish();
+    bool Promotable(const std::string &name, llvm::Type *type);
+    unsigned NewVariable(llvm::Type *type, const std::string &name);
+    void WriteVariable(unsigned var, llvm::BasicBlock *block, llvm::Value *value);
+    llvm::Value *ReadVariable(unsigned var, llvm::BasicBlock *block);
+    // all predecessors of block are known
+    void SealBlock(llvm::BasicBlock *block);
+};
+} // namespace ir
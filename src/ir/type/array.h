@@ -0,0 +1,21 @@
+#pragma once
+#include "type.h"
+
+namespace ir
+{
+// fixed size array, nested arrays are laid out contiguously (row major)
+class ArrayTy : public ir::ReferType
+{
+private:
+    ArrayTy() = default;
+
+public:
+    ArrayTy(llvm::Type *type, uint64_t size, bool is_const);
+
+public:
+    uint64_t size;
+
+    std::string TyInfo();
+    static ir::ArrayTy *Get(ir::RootType *element, uint64_t size, bool is_const);
+};
+} // namespace ir
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "../global.h"
+#include "array.h"
 #include "float.h"
 #include "function.h"
 #include "integer.h"
@@ -3,12 +3,18 @@
 
 namespace ir
 {
-class Pointer : public ir::ReferType
+class PointerTy : public ir::ReferType
 {
 private:
-    Pointer() = default;
+    PointerTy() = default;
 
 public:
+    PointerTy(llvm::Type *type, bool is_const, bool is_restrict);
+
+public:
+    bool is_restrict; // the only way to reach its pointee, see ir::AliasScopes
+
     std::string TyInfo();
+    static ir::PointerTy *Get(ir::RootType *pointee, bool is_const, bool is_restrict = false);
 };
 } // namespace ir
\ No newline at end of file
@@ -24,17 +24,38 @@ std::shared_ptr<ir::Symbol> ir::Symbol::LValue()
 {
     if (!this->is_lvalue)
         Errors(nullptr, "\'" + this->name + "\' : use a RValue as LValue.");
-    auto res = std::make_shared<ir::Symbol>(this->type, this->name + "_LValue", true);
+    // share the storage, don't allocate again
+    auto res = std::make_shared<ir::Symbol>(this->type, this->name + "_LValue", false);
     res->is_lvalue = true;
     res->value = this->value;
+    res->ssa_var = this->ssa_var;
+    res->restrict_scope = this->restrict_scope;
+    res->access_scope = this->access_scope;
     return res;
 }
 std::shared_ptr<ir::Symbol> ir::Symbol::RValue()
 {
     auto res = std::make_shared<ir::Symbol>(this->type, this->name + "_RValue", false);
-    if (this->is_lvalue)
+    res->restrict_scope = this->restrict_scope;
+    // an array decays to the pointer to its first element
+    if (this->is_lvalue && this->type->Top()->type_name == ir::TypeName::Array)
     {
-        res->value = builder->CreateLoad(this->value);
+        res->restrict_scope = this->access_scope;
+        auto array_ty = this->type->Top()->_ty;
+        res->type = std::make_shared<ir::Type>(*this->type);
+        res->type->DeReference();
+        res->type->_tys.push_back(ir::PointerTy::Get(res->type->Top(), false));
+        res->value = builder->CreateInBoundsGEP(array_ty, this->value, {builder->getInt64(0), builder->getInt64(0)}, "array_decay");
+    }
+    else if (this->is_lvalue)
+    {
+        if (this->ssa_var >= 0)
+            res->value = ssa_builder.ReadVariable(this->ssa_var, builder->GetInsertBlock());
+        else
+        {
+            res->value = builder->CreateLoad(this->value);
+            alias_scopes.Tag(res->value, this->access_scope);
+        }
     }
     else
         res->value = this->value;
@@ -67,15 +88,36 @@ std::shared_ptr<ir::Symbol> ir::Symbol::CastTo(ir::RootType *type)
         return res;
     }
 }
+// '*p', the pointee as a LValue
 std::shared_ptr<ir::Symbol> ir::Symbol::DeReference()
 {
-    if (this->is_lvalue)
-        Errors(nullptr, "deference a LValue.");
-    auto res = std::make_shared<ir::Symbol>(this->type, this->name + "_RValue", false);
-    if (!res->type->DeReference())
+    auto pointer = this->RValue();
+    if (pointer->type->Top()->type_name != ir::TypeName::Pointer)
     {
         Errors(nullptr, "\'" + this->name + "\' : dereference a non-pointer type symbol.");
     }
+    auto type = std::make_shared<ir::Type>(*pointer->type);
+    type->DeReference();
+    if (type->Top()->type_name == ir::TypeName::Void)
+    {
+        Errors(nullptr, "\'" + this->name + "\' : dereference a \'void *\'.");
+    }
+    auto res = ir::Symbol::GetReference(type, pointer->value);
+    res->name = this->name + "_deref";
+    res->access_scope = pointer->restrict_scope;
+    return res;
+}
+// '&a'
+std::shared_ptr<ir::Symbol> ir::Symbol::Reference()
+{
+    if (!this->is_lvalue)
+        Errors(nullptr, "\'" + this->name + "\' : cannot take the address of a RValue.");
+    if (this->ssa_var >= 0)
+        Errors(nullptr, "\'" + this->name + "\' : register variable has no address.");
+    auto type = std::make_shared<ir::Type>(*this->type);
+    type->_tys.push_back(ir::PointerTy::Get(type->Top(), false));
+    auto res = std::make_shared<ir::Symbol>(type, this->name + "_addr", false);
+    res->value = this->value;
     return res;
 }
 llvm::Value *ir::Symbol::GetValue()
@@ -85,9 +127,16 @@ llvm::Value *ir::Symbol::GetValue()
 // val should be a RValue
 llvm::Value *ir::Symbol::Store(llvm::Value *val)
 {
-    if (this->is_lvalue)
+    if (this->is_lvalue && this->ssa_var >= 0)
     {
-        return builder->CreateStore(val, this->value);
+        ssa_builder.WriteVariable(this->ssa_var, builder->GetInsertBlock(), val);
+        return val;
+    }
+    else if (this->is_lvalue)
+    {
+        auto store = builder->CreateStore(val, this->value);
+        alias_scopes.Tag(store, this->access_scope);
+        return store;
     }
     else
     {
@@ -99,7 +148,7 @@ llvm::Value *ir::Symbol::Assign(std::shared_ptr<ir::Symbol> val)
     if (!this->is_lvalue)
         Errors(nullptr, "\'" + this->name + "\' : a RValue can't be assigned.");
     auto rhs_symbol = val->RValue();
-    auto rhs_type = val->type;
+    auto rhs_type = rhs_symbol->type;
     auto rhs_val = rhs_symbol->value;
     // type check
     auto lhs_symbol = this;
@@ -163,17 +212,29 @@ llvm::Value *ir::Symbol::Assign(std::shared_ptr<ir::Symbol> val)
            << "\'" << rhs_type->TyInfo() << "\' from \'" << lhs_type->TyInfo() << "\' and \' " << rhs_type->TyInfo() << "\'.\n";
         Errors(nullptr, ss.str());
     }
+    // implicit conversion between base types, e.g. a bool compare result to int
+    if (lhs_type->_tys.empty() && rhs_type->_tys.empty() && rhs_val->getType() != lhs_type->Top()->_ty)
+    {
+        rhs_val = rhs_symbol->CastTo(lhs_type->Top())->GetValue();
+    }
     return this->Store(rhs_val);
 }
 bool ir::Symbol::IsValid()
 {
-    return this->value != nullptr;
+    return this->value != nullptr || this->ssa_var >= 0;
 }
 std::shared_ptr<ir::Symbol> ir::Symbol::Get(std::shared_ptr<ir::Type> type, const std::string &name)
 {
     auto res = new ir::Symbol(type, name, true);
     return (std::shared_ptr<ir::Symbol>)res;
 }
+std::shared_ptr<ir::Symbol> ir::Symbol::GetReference(std::shared_ptr<ir::Type> type, llvm::Value *address)
+{
+    auto res = std::make_shared<ir::Symbol>(type, "ref_", false);
+    res->is_lvalue = true;
+    res->value = address;
+    return res;
+}
 std::shared_ptr<ir::Symbol> ir::Symbol::GetConstant(std::shared_ptr<ir::Type> type, llvm::Value *val)
 {
     auto res = std::make_shared<ir::Symbol>(type);
@@ -184,5 +245,16 @@ std::shared_ptr<ir::Symbol> ir::Symbol::GetConstant(std::shared_ptr<ir::Type> ty
 llvm::Value *ir::Symbol::Allocate(const std::string &name)
 {
     auto _ty = this->type->Top()->_ty;
-    return builder->CreateAlloca(_ty, nullptr, name);
+    if (ssa_builder.Promotable(name, _ty))
+    {
+        this->ssa_var = ssa_builder.NewVariable(_ty, name);
+        return nullptr;
+    }
+    auto insert_bb = builder->GetInsertBlock();
+    if (!insert_bb)
+        return builder->CreateAlloca(_ty, nullptr, name);
+    // all stack slots live in the entry block, scopes are marked by lifetime intrinsics
+    auto &entry = insert_bb->getParent()->getEntryBlock();
+    llvm::IRBuilder<> entry_builder(&entry, entry.begin());
+    return entry_builder.CreateAlloca(_ty, nullptr, name);
 }
\ No newline at end of file
@@ -9,13 +9,16 @@ namespace ir
 class Symbol
 {
 protected:
-    llvm::Value *value;
+    llvm::Value *value = nullptr;
+    int ssa_var = -1; // register-promoted variable, see ir::SSABuilder
     llvm::Value *Allocate(const std::string &name);
 
 public:
     std::string name;
     std::shared_ptr<ir::Type> type;
     bool is_lvalue;
+    llvm::MDNode *restrict_scope = nullptr; // the pointer it holds is based on a restrict pointer
+    llvm::MDNode *access_scope = nullptr;   // its storage is reached through a restrict pointer
     std::shared_ptr<ir::Symbol> LValue();
     std::shared_ptr<ir::Symbol> RValue();
     std::shared_ptr<ir::Symbol> CastTo(ir::RootType *type);
@@ -27,6 +30,7 @@ public:
     bool IsValid();
     static std::shared_ptr<ir::Symbol> Get(std::shared_ptr<ir::Type> type, const std::string &name);
     static std::shared_ptr<ir::Symbol> GetConstant(std::shared_ptr<ir::Type> type, llvm::Value *val);
+    static std::shared_ptr<ir::Symbol> GetReference(std::shared_ptr<ir::Type> type, llvm::Value *address); // LValue of existing storage
 
     Symbol(std::shared_ptr<ir::Type> type, const std::string &name, bool is_lvalue); // normal symbol
     Symbol(std::shared_ptr<ir::Type> type);                                          // constant
@@ -1,7 +1,10 @@
 #include "../global.h"
 #include "index.h"
+#include <llvm/IR/DerivedTypes.h>
 #include <llvm/Support/raw_ostream.h>
+#include <map>
 #include <sstream>
+#include <tuple>
 #include <unordered_map>
 
 // BaseType
@@ -115,7 +118,7 @@ std::shared_ptr<ir::Type> ir::Type::CastTo(std::shared_ptr<ir::Type> type)
         valid = false;
     }
     // int->pointer
-    else if (dynamic_cast<ir::IntegerTy *>(from_base) && to_type->Top()->type_name == ir::TypeName::Pointer)
+    else if (from_tys.empty() && dynamic_cast<ir::IntegerTy *>(from_base) && to_type->Top()->type_name == ir::TypeName::Pointer)
     {
         valid = true;
     }
@@ -131,25 +134,19 @@ std::shared_ptr<ir::Type> ir::Type::CastTo(std::shared_ptr<ir::Type> type)
                 res->_bty = from_base->type_name == ir::TypeName::Float ? from_base : to_base;
             }
         }
-        // else it has to be a non-const to const cast
+        // else the pointee must be the same, only qualifiers may be added
         else
         {
-            for (auto i = 0; i < from_tys.size(); ++i)
+            valid = from_base->_ty == to_base->_ty;
+            for (auto i = 0; valid && i < from_tys.size(); ++i)
             {
-                // the n-1 level must be same
                 auto f_ty = from_tys[i];
                 auto t_ty = to_tys[i];
-                // if not top level, const qualifier must be same
+                // the top level qualifier doesn't matter for a value
                 if (f_ty->type_name != t_ty->type_name ||
-                    i + 1 != from_tys.size() && f_ty->is_const != t_ty->is_const)
+                    i + 1 != from_tys.size() && f_ty->is_const && !t_ty->is_const)
                 {
-                    valid = false;
-                    break;
-                }
-                // the top level: from: non-const, to: const
-                else if (f_ty->is_const || !t_ty->is_const)
-                {
-                    ss << "non-const type cannot cast to const type.\n";
+                    ss << "pointee type or qualifier not match.\n";
                     valid = false;
                 }
             }
@@ -187,12 +184,12 @@ bool ir::Type::Equal(std::shared_ptr<ir::Type> type)
 }
 
 // [IntegerTy]
-static std::unordered_map<int, std::shared_ptr<ir::IntegerTy>> IntManager;
+static thread_local std::unordered_map<int, std::shared_ptr<ir::IntegerTy>> IntManager;
 llvm::Type *ir::IntegerTy::GetBitType(int bits)
 {
     return llvm::IntegerType::getIntNTy(*context, bits);
 }
-ir::IntegerTy::IntegerTy(int bits, bool is_sign, bool is_const) : bits(bits), BaseType(ir::IntegerTy::GetBitType(bits), ir::TypeName::Integer, is_const) {}
+ir::IntegerTy::IntegerTy(int bits, bool is_sign, bool is_const) : bits(bits), is_sign(is_sign), BaseType(ir::IntegerTy::GetBitType(bits), ir::TypeName::Integer, is_const) {}
 
 llvm::Value *ir::IntegerTy::CastTo(ir::RootType *type, llvm::Value *value)
 {
@@ -207,7 +204,8 @@ llvm::Value *ir::IntegerTy::CastTo(ir::RootType *type, llvm::Value *value)
         return this->is_sign ? builder->CreateSIToFP(value, dest_ty, "si2f_tmp") : builder->CreateUIToFP(value, dest_ty, "ui2f_tmp");
         break;
     case ir::TypeName::Integer:
-        return builder->CreateIntCast(value, dest_type->_ty, ((ir::IntegerTy *)dest_type)->is_sign, "i2i_tmp");
+        // extension follows the signedness of the source
+        return builder->CreateIntCast(value, dest_type->_ty, this->is_sign, "i2i_tmp");
         break;
     case ir::TypeName::Pointer:
         return builder->CreateIntToPtr(value, dest_ty, "i2p_tmp");
@@ -239,13 +237,13 @@ std::string ir::IntegerTy::TyInfo()
     auto bits = this->bits;
     auto is_sign = this->is_sign;
     std::stringstream ss;
-    ss << (is_sign ? "unsigned" : "");
+    ss << (!is_sign ? "unsigned" : "");
     ss << " " << ((bits == 1) ? "bool" : (bits == 8) ? "char" : (bits == 16) ? "short" : (bits == 32) ? "int" : (bits == 64) ? "long" : (bits == 128) ? "long long" : "");
     return ss.str();
 }
 
 // [FloatTy]
-static std::unordered_map<int, std::shared_ptr<ir::FloatTy>> FloatManager;
+static thread_local std::unordered_map<int, std::shared_ptr<ir::FloatTy>> FloatManager;
 llvm::Type *ir::FloatTy::GetBitType(int bits)
 {
     return bits == 32
@@ -305,7 +303,7 @@ std::string ir::VoidTy::TyInfo()
 {
     return "void";
 }
-static std::shared_ptr<ir::VoidTy> vty = nullptr;
+static thread_local std::shared_ptr<ir::VoidTy> vty = nullptr;
 ir::VoidTy *ir::VoidTy::Get()
 {
     vty = std::make_shared<ir::VoidTy>();
@@ -356,8 +354,45 @@ bool ir::FunctionTy::Equal(std::shared_ptr<ir::FunctionTy> function)
     return true;
 }
 
-// [Pointer]
-std::string ir::Pointer::TyInfo()
+// [PointerTy]
+static thread_local std::map<std::tuple<llvm::Type *, bool, bool>, std::shared_ptr<ir::PointerTy>> PointerManager;
+ir::PointerTy::PointerTy(llvm::Type *type, bool is_const, bool is_restrict) : is_restrict(is_restrict), ir::ReferType(type, ir::TypeName::Pointer, is_const) {}
+ir::PointerTy *ir::PointerTy::Get(ir::RootType *pointee, bool is_const, bool is_restrict)
+{
+    // llvm has no void*, use i8* like clang
+    auto pointee_ty = pointee->_ty->isVoidTy() ? llvm::Type::getInt8Ty(*context) : pointee->_ty;
+    auto key = std::make_tuple(pointee_ty, is_const, is_restrict);
+    if (!PointerManager.count(key))
+        PointerManager[key] = std::make_shared<ir::PointerTy>(pointee_ty->getPointerTo(), is_const, is_restrict);
+    return PointerManager.at(key).get();
+}
+std::string ir::PointerTy::TyInfo()
+{
+    std::stringstream ss;
+    ss << "*" << (this->is_const ? " const" : "") << (this->is_restrict ? " restrict" : "");
+    return ss.str();
+}
+
+// [ArrayTy]
+static thread_local std::map<std::tuple<llvm::Type *, uint64_t, bool>, std::shared_ptr<ir::ArrayTy>> ArrayManager;
+ir::ArrayTy::ArrayTy(llvm::Type *type, uint64_t size, bool is_const) : size(size), ir::ReferType(type, ir::TypeName::Array, is_const) {}
+ir::ArrayTy *ir::ArrayTy::Get(ir::RootType *element, uint64_t size, bool is_const)
+{
+    auto key = std::make_tuple(element->_ty, size, is_const);
+    if (!ArrayManager.count(key))
+        ArrayManager[key] = std::make_shared<ir::ArrayTy>(llvm::ArrayType::get(element->_ty, size), size, is_const);
+    return ArrayManager.at(key).get();
+}
+std::string ir::ArrayTy::TyInfo()
+{
+    std::stringstream ss;
+    ss << "[" << this->size << "]";
+    return ss.str();
+}
+void ir::ClearTypes()
 {
-    return "*";
+    IntManager.clear();
+    FloatManager.clear();
+    PointerManager.clear();
+    ArrayManager.clear();
 }
\ No newline at end of file
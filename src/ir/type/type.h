@@ -64,4 +64,6 @@ public:
     static std::shared_ptr<ir::Type> Get(std::vector<ir::RootType *> &types);
     static std::shared_ptr<ir::Type> GetConstantType(const std::string &type);
 };
+// the types below are cached per thread for the current context, a new one drops them
+void ClearTypes();
 } // namespace ir
\ No newline at end of file
@@ -0,0 +1,743 @@
+#include "jit.h"
+#include "../ir/ir.h"
+#include "../tc/tc.h"
+#include <atomic>
+#include <chrono>
+#include <llvm/Support/FileSystem.h>
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace llvm;
+
+#if LLVM_VERSION_MAJOR >= 8
+// ORC LLJIT, symbols the module doesn't define come from this process (libc)
+std::unique_ptr<jit::Native> jit::Native::Create(std::unique_ptr<Module> module, std::unique_ptr<LLVMContext> context)
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return nullptr;
+    orc::JITTargetMachineBuilder JTMB(Machine->getTargetTriple());
+    JTMB.setCPU(Machine->getTargetCPU().str());
+    JTMB.addFeatures(SubtargetFeatures(Machine->getTargetFeatureString()).getFeatures());
+    JTMB.setCodeGenOptLevel(Machine->getOptLevel());
+
+#if LLVM_VERSION_MAJOR >= 9
+    auto JIT = orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(JTMB)).create();
+#else
+    auto JIT = orc::LLJIT::Create(std::move(JTMB), Machine->createDataLayout());
+#endif
+    if (!JIT)
+    {
+        errs() << toString(JIT.takeError()) << "\n";
+        return nullptr;
+    }
+    // the generator takes the global prefix from 9, the data layout before
+#if LLVM_VERSION_MAJOR >= 9
+    auto Generator = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess((*JIT)->getDataLayout().getGlobalPrefix());
+#else
+    auto Generator = orc::DynamicLibrarySearchGenerator::GetForCurrentProcess((*JIT)->getDataLayout());
+#endif
+    if (!Generator)
+    {
+        errs() << toString(Generator.takeError()) << "\n";
+        return nullptr;
+    }
+#if LLVM_VERSION_MAJOR >= 10
+    (*JIT)->getMainJITDylib().addGenerator(std::move(*Generator));
+#else
+    (*JIT)->getMainJITDylib().setGenerator(std::move(*Generator));
+#endif
+
+    // the jit owns the module and its context from here
+    if (auto Err = (*JIT)->addIRModule(orc::ThreadSafeModule(std::move(module), std::move(context))))
+    {
+        errs() << toString(std::move(Err)) << "\n";
+        return nullptr;
+    }
+    std::unique_ptr<jit::Native> res(new jit::Native);
+    res->jit = std::move(*JIT);
+    return res;
+}
+bool jit::Native::Add(std::unique_ptr<Module> module, std::unique_ptr<LLVMContext> context)
+{
+    if (auto Err = this->jit->addIRModule(orc::ThreadSafeModule(std::move(module), std::move(context))))
+    {
+        errs() << toString(std::move(Err)) << "\n";
+        return false;
+    }
+    return true;
+}
+bool jit::Native::Define(const std::string &name, void *address)
+{
+#if LLVM_VERSION_MAJOR >= 17
+    orc::ExecutorSymbolDef Symbol(orc::ExecutorAddr::fromPtr(address), JITSymbolFlags::Exported);
+#else
+    JITEvaluatedSymbol Symbol(pointerToJITTargetAddress(address), JITSymbolFlags::Exported);
+#endif
+#if LLVM_VERSION_MAJOR >= 10
+    auto Err = this->jit->getMainJITDylib().define(orc::absoluteSymbols({{this->jit->mangleAndIntern(name), Symbol}}));
+#else
+    auto Err = this->jit->defineAbsolute(name, Symbol);
+#endif
+    if (Err)
+    {
+        errs() << toString(std::move(Err)) << "\n";
+        return false;
+    }
+    return true;
+}
+void *jit::Native::Lookup(const std::string &name)
+{
+    auto Symbol = this->jit->lookup(name);
+    if (!Symbol)
+    {
+        errs() << toString(Symbol.takeError()) << "\n";
+        return nullptr;
+    }
+#if LLVM_VERSION_MAJOR >= 15
+    return Symbol->toPtr<void *>();
+#else
+    return (void *)Symbol->getAddress();
+#endif
+}
+#else
+// no LLJIT before LLVM 8, MCJIT through the ExecutionEngine instead
+std::unique_ptr<jit::Native> jit::Native::Create(std::unique_ptr<Module> module, std::unique_ptr<LLVMContext> context)
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return nullptr;
+    // undefined symbols resolve against this process (libc)
+    sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+    std::string Error;
+    EngineBuilder Builder(std::move(module));
+    Builder.setEngineKind(EngineKind::JIT)
+        .setErrorStr(&Error)
+        .setOptLevel(Machine->getOptLevel())
+        .setMCPU(Machine->getTargetCPU())
+        .setMAttrs(SubtargetFeatures(Machine->getTargetFeatureString()).getFeatures());
+    std::unique_ptr<ExecutionEngine> Engine(Builder.create());
+    if (!Engine)
+    {
+        errs() << Error << "\n";
+        return nullptr;
+    }
+    std::unique_ptr<jit::Native> res(new jit::Native);
+    res->contexts.push_back(std::move(context));
+    res->engine = std::move(Engine);
+    return res;
+}
+bool jit::Native::Add(std::unique_ptr<Module> module, std::unique_ptr<LLVMContext> context)
+{
+    this->engine->addModule(std::move(module));
+    this->contexts.push_back(std::move(context));
+    return true;
+}
+bool jit::Native::Define(const std::string &name, void *address)
+{
+    // the engine checks its mappings before the process, by the mangled name
+    SmallString<64> mangled;
+    Mangler::getNameWithPrefix(mangled, name, this->engine->getDataLayout());
+    this->engine->addGlobalMapping(mangled, (uint64_t)address);
+    return true;
+}
+void *jit::Native::Lookup(const std::string &name)
+{
+    // functions and the globals they use, e.g. the slots of '-fhot-reload'
+    auto address = this->engine->getGlobalValueAddress(name);
+    if (!address)
+        errs() << "symbol '" << name << "' not found\n";
+    return (void *)address;
+}
+#endif
+
+int jit::run(const std::vector<std::string> &args)
+{
+    auto native = jit::Native::Create(std::move(module), std::move(context));
+    if (!native)
+        return 1;
+    auto main_function = (int (*)(int, char **))native->Lookup("main");
+    if (!main_function)
+        return 1;
+    std::vector<char *> argv;
+    for (auto &arg : args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+    return main_function(args.size(), argv.data());
+}
+
+// [tiered]
+// the interpreter calls the hooks below, a function whose calls and back edges
+// reach the threshold is compiled and its next calls go through 'name.tier'
+// to the native code. a running interpreted call isn't replaced (no osr).
+// each promotion compiles a module of its own, the cold functions never are
+struct TierFunction
+{
+    std::string name;
+    uint64_t count;
+    bool failed;
+    uint64_t (*native)(uint64_t *args);
+};
+static std::vector<TierFunction> tier_functions;
+static uint64_t tier_threshold;
+// the copy with the entries, each promotion takes what it compiles from it
+static SmallVector<char, 0> tier_bitcode;
+// external symbols the native code defines so far
+static std::set<std::string> tier_compiled;
+static std::unique_ptr<jit::Native> tier_native;
+// the variables of the program live in the interpreter
+static ExecutionEngine *tier_interpreter;
+
+// a module of the hot function and what it reaches that isn't native yet, with
+// their entries. the rest are declarations, found in the modules before
+static bool compileTier(const std::string &name)
+{
+    std::unique_ptr<LLVMContext> promote_context(new LLVMContext);
+    auto copy = parseBitcodeFile(MemoryBufferRef(StringRef(tier_bitcode.data(), tier_bitcode.size()), "tier"),
+                                 *promote_context);
+    if (!copy)
+    {
+        errs() << toString(copy.takeError()) << "\n";
+        return false;
+    }
+    auto promoted = std::move(*copy);
+
+    // locals can't be shared between modules, every module has its own copy
+    auto compiled = [](const GlobalValue &value) {
+        return !value.hasLocalLinkage() && tier_compiled.count(value.getName().str());
+    };
+    std::set<Function *> reached;
+    std::set<GlobalIFunc *> ifuncs;
+    std::vector<Function *> work = {promoted->getFunction(name)};
+    while (!work.empty())
+    {
+        auto function = work.back();
+        work.pop_back();
+        if (!function || function->isDeclaration() || compiled(*function) || !reached.insert(function).second)
+            continue;
+        for (auto &block : *function)
+        {
+            for (auto &inst : block)
+            {
+                for (auto &op : inst.operands())
+                {
+                    auto value = op->stripPointerCasts();
+                    // '-fmultiversion', the resolver and the copies come along
+                    auto ifunc = dyn_cast<GlobalIFunc>(value);
+                    if (ifunc && !compiled(*ifunc) && ifuncs.insert(ifunc).second)
+                        value = ifunc->getResolver()->stripPointerCasts();
+                    if (auto callee = dyn_cast<Function>(value))
+                        work.push_back(callee);
+                }
+            }
+        }
+    }
+
+    // 'name.tier' goes with name
+    for (auto &function : *promoted)
+    {
+        auto base = function.getName();
+        if (base.endswith(".tier"))
+            base = base.drop_back(5);
+        auto owner = promoted->getFunction(base);
+        if (!function.isDeclaration() && !(owner && reached.count(owner)))
+            function.deleteBody();
+    }
+    std::vector<GlobalIFunc *> other_ifuncs;
+    for (auto &ifunc : promoted->ifuncs())
+    {
+        if (!ifuncs.count(&ifunc))
+            other_ifuncs.push_back(&ifunc);
+    }
+    for (auto ifunc : other_ifuncs)
+    {
+        auto declaration = Function::Create(cast<FunctionType>(ifunc->getValueType()), GlobalValue::ExternalLinkage,
+                                            "", promoted.get());
+        declaration->takeName(ifunc);
+        ifunc->replaceAllUsesWith(ConstantExpr::getBitCast(declaration, ifunc->getType()));
+        ifunc->eraseFromParent();
+    }
+    // a local declaration isn't valid, unused ones go
+    std::vector<Function *> locals;
+    for (auto &function : *promoted)
+    {
+        if (function.isDeclaration() && function.hasLocalLinkage())
+            locals.push_back(&function);
+    }
+    for (auto function : locals)
+    {
+        if (function->use_empty())
+            function->eraseFromParent();
+        else
+            function->setLinkage(GlobalValue::ExternalLinkage);
+    }
+
+    // a variable is the interpreter's, the native code reads and writes the same storage.
+    // a constant can be copied, one definition of it, the first module's
+    std::vector<std::pair<std::string, void *>> storage;
+    for (auto &variable : promoted->globals())
+    {
+        if (variable.isDeclaration() || (variable.isConstant() && !compiled(variable)))
+            continue;
+        auto variable_name = variable.getName().str();
+        if (!variable.isConstant() && !tier_compiled.count(variable_name))
+        {
+            auto interpreted = tier_interpreter->FindGlobalVariableNamed(variable_name, true);
+            if (!interpreted)
+            {
+                errs() << "variable '" << variable_name << "' not found in the interpreter\n";
+                return false;
+            }
+            storage.push_back({variable_name, tier_interpreter->getPointerToGlobal(interpreted)});
+        }
+        variable.setInitializer(nullptr);
+        variable.setLinkage(GlobalValue::ExternalLinkage);
+    }
+
+    for (auto &function : *promoted)
+    {
+        if (!function.isDeclaration() && !function.hasLocalLinkage())
+            tier_compiled.insert(function.getName().str());
+    }
+    for (auto &variable : promoted->globals())
+    {
+        if (!variable.isDeclaration() && !variable.hasLocalLinkage())
+            tier_compiled.insert(variable.getName().str());
+    }
+    for (auto ifunc : ifuncs)
+        tier_compiled.insert(ifunc->getName().str());
+    if (!tier_native)
+    {
+        tier_native = jit::Native::Create(std::move(promoted), std::move(promote_context));
+        if (!tier_native)
+            return false;
+    }
+    else if (!tier_native->Add(std::move(promoted), std::move(promote_context)))
+        return false;
+    // before the first lookup links the module
+    for (auto &variable : storage)
+    {
+        if (!tier_native->Define(variable.first, variable.second))
+            return false;
+        tier_compiled.insert(variable.first);
+    }
+    return true;
+}
+
+static void promote(TierFunction &function)
+{
+    // maybe compiled already, called by a function promoted before
+    auto ready = tier_compiled.count(function.name) || compileTier(function.name);
+    auto address = ready ? tier_native->Lookup(function.name + ".tier") : nullptr;
+    function.failed = !address;
+    function.native = (uint64_t(*)(uint64_t *))address;
+}
+
+// the interpreter looks external functions up as 'lle_X_<name>'
+static GenericValue tierEnter(FunctionType *, ArrayRef<GenericValue> args)
+{
+    auto &function = tier_functions[args[0].IntVal.getZExtValue()];
+    if (!function.native && !function.failed && ++function.count >= tier_threshold)
+        promote(function);
+    GenericValue res;
+    res.IntVal = APInt(1, function.native != nullptr);
+    return res;
+}
+static GenericValue tierBackEdge(FunctionType *, ArrayRef<GenericValue> args)
+{
+    ++tier_functions[args[0].IntVal.getZExtValue()].count;
+    return GenericValue();
+}
+static GenericValue tierCall(FunctionType *, ArrayRef<GenericValue> args)
+{
+    auto &function = tier_functions[args[0].IntVal.getZExtValue()];
+    GenericValue res;
+    res.IntVal = APInt(64, function.native((uint64_t *)GVTOP(args[1])));
+    return res;
+}
+
+// arguments and results cross the tiers as 64 bit words
+static bool isWordType(Type *type)
+{
+    return (type->isIntegerTy() && type->getIntegerBitWidth() <= 64) || type->isFloatTy() || type->isDoubleTy() ||
+           type->isPointerTy();
+}
+static Value *toWord(IRBuilder<> &word_builder, Value *value)
+{
+    auto type = value->getType();
+    auto int64_ty = word_builder.getInt64Ty();
+    if (type->isPointerTy())
+        return word_builder.CreatePtrToInt(value, int64_ty);
+    if (type->isFloatTy())
+        value = word_builder.CreateBitCast(value, word_builder.getInt32Ty());
+    else if (type->isDoubleTy())
+        return word_builder.CreateBitCast(value, int64_ty);
+    return word_builder.CreateZExtOrBitCast(value, int64_ty);
+}
+static Value *fromWord(IRBuilder<> &word_builder, Value *word, Type *type)
+{
+    if (type->isPointerTy())
+        return word_builder.CreateIntToPtr(word, type);
+    if (type->isFloatTy())
+        return word_builder.CreateBitCast(word_builder.CreateTrunc(word, word_builder.getInt32Ty()), type);
+    if (type->isDoubleTy())
+        return word_builder.CreateBitCast(word, type);
+    return word_builder.CreateTruncOrBitCast(word, type);
+}
+static bool tierSupported(Function &function)
+{
+    if (function.isDeclaration() || function.isVarArg())
+        return false;
+    auto return_ty = function.getReturnType();
+    if (!return_ty->isVoidTy() && !isWordType(return_ty))
+        return false;
+    for (auto &arg : function.args())
+    {
+        if (!isWordType(arg.getType()))
+            return false;
+    }
+    return true;
+}
+
+// 'i64 name.tier(i64 *args)' in the native copy, calls name with the unpacked words
+static void addTierEntry(Function &function)
+{
+    auto &ctx = function.getContext();
+    auto int64_ty = Type::getInt64Ty(ctx);
+    auto entry = Function::Create(FunctionType::get(int64_ty, {int64_ty->getPointerTo()}, false),
+                                  GlobalValue::ExternalLinkage, function.getName() + ".tier", function.getParent());
+    IRBuilder<> entry_builder(BasicBlock::Create(ctx, "entry", entry));
+    std::vector<Value *> call_args;
+    for (auto &arg : function.args())
+    {
+        auto slot = entry_builder.CreateConstInBoundsGEP1_32(int64_ty, &*entry->arg_begin(), arg.getArgNo());
+        call_args.push_back(fromWord(entry_builder, entry_builder.CreateLoad(int64_ty, slot), arg.getType()));
+    }
+    auto res = entry_builder.CreateCall(&function, call_args);
+    entry_builder.CreateRet(function.getReturnType()->isVoidTy() ? entry_builder.getInt64(0) : toWord(entry_builder, res));
+}
+
+// count the calls and back edges of the interpreted function, once it is native
+// the entry packs the arguments and calls it instead of running the body
+static void instrumentTier(Function &function, unsigned id)
+{
+    auto &ctx = function.getContext();
+    auto interpreted = function.getParent();
+    auto int32_ty = Type::getInt32Ty(ctx);
+    auto int64_ty = Type::getInt64Ty(ctx);
+    auto enter_hook = interpreted->getOrInsertFunction("__ncc_tier_enter", Type::getInt1Ty(ctx), int32_ty);
+    auto back_edge_hook = interpreted->getOrInsertFunction("__ncc_tier_back_edge", Type::getVoidTy(ctx), int32_ty);
+    auto call_hook = interpreted->getOrInsertFunction("__ncc_tier_call", int64_ty, int32_ty, int64_ty->getPointerTo());
+
+    SmallVector<std::pair<const BasicBlock *, const BasicBlock *>, 8> back_edges;
+    FindFunctionBackedges(function, back_edges);
+    for (auto &edge : back_edges)
+    {
+        IRBuilder<> hook_builder(const_cast<BasicBlock *>(edge.first)->getTerminator());
+        hook_builder.CreateCall(back_edge_hook, {hook_builder.getInt32(id)});
+    }
+
+    auto &body = function.getEntryBlock();
+    auto entry = BasicBlock::Create(ctx, "tier_entry", &function, &body);
+    auto native = BasicBlock::Create(ctx, "tier_native", &function, &body);
+    IRBuilder<> hook_builder(entry);
+    hook_builder.CreateCondBr(hook_builder.CreateCall(enter_hook, {hook_builder.getInt32(id)}), native, &body);
+
+    hook_builder.SetInsertPoint(native);
+    auto words = hook_builder.CreateAlloca(int64_ty, hook_builder.getInt32(std::max<size_t>(function.arg_size(), 1)));
+    for (auto &arg : function.args())
+    {
+        auto slot = hook_builder.CreateConstInBoundsGEP1_32(int64_ty, words, arg.getArgNo());
+        hook_builder.CreateStore(toWord(hook_builder, &arg), slot);
+    }
+    auto res = hook_builder.CreateCall(call_hook, {hook_builder.getInt32(id), words});
+    if (function.getReturnType()->isVoidTy())
+        hook_builder.CreateRetVoid();
+    else
+        hook_builder.CreateRet(fromWord(hook_builder, res, function.getReturnType()));
+}
+
+int jit::runTiered(const std::vector<std::string> &args, uint64_t threshold)
+{
+    auto main_function = module->getFunction("main");
+    if (!main_function || main_function->isDeclaration())
+    {
+        errs() << "no main function to run\n";
+        return 1;
+    }
+    tier_threshold = threshold;
+
+    // the native copy lives in its own context, the interpreter keeps this one
+    SmallVector<char, 0> bitcode;
+    raw_svector_ostream bitcode_stream(bitcode);
+#if LLVM_VERSION_MAJOR >= 7
+    WriteBitcodeToFile(*module, bitcode_stream);
+#else
+    WriteBitcodeToFile(module.get(), bitcode_stream);
+#endif
+    LLVMContext tier_context;
+    auto copy = parseBitcodeFile(MemoryBufferRef(StringRef(bitcode.data(), bitcode.size()), "tier"), tier_context);
+    if (!copy)
+    {
+        errs() << toString(copy.takeError()) << "\n";
+        return 1;
+    }
+    auto tier_module = std::move(*copy);
+
+    std::vector<Function *> functions;
+    for (auto &function : *module)
+    {
+        if (tierSupported(function))
+            functions.push_back(&function);
+    }
+    for (auto function : functions)
+    {
+        addTierEntry(*tier_module->getFunction(function->getName()));
+        instrumentTier(*function, tier_functions.size());
+        tier_functions.push_back({function->getName().str(), 0, false, nullptr});
+    }
+    // a static variable can be declared by the modules of the promotions, they use the interpreter's
+    for (auto &variable : tier_module->globals())
+    {
+        if (variable.hasLocalLinkage() && !variable.isConstant())
+            variable.setLinkage(GlobalValue::ExternalLinkage);
+    }
+    raw_svector_ostream tier_stream(tier_bitcode);
+#if LLVM_VERSION_MAJOR >= 7
+    WriteBitcodeToFile(*tier_module, tier_stream);
+#else
+    WriteBitcodeToFile(tier_module.get(), tier_stream);
+#endif
+    sys::DynamicLibrary::AddSymbol("lle_X___ncc_tier_enter", (void *)tierEnter);
+    sys::DynamicLibrary::AddSymbol("lle_X___ncc_tier_back_edge", (void *)tierBackEdge);
+    sys::DynamicLibrary::AddSymbol("lle_X___ncc_tier_call", (void *)tierCall);
+    // libc for the interpreted code
+    sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+    std::string Error;
+    std::unique_ptr<ExecutionEngine> Interpreter(
+        EngineBuilder(std::move(module)).setEngineKind(EngineKind::Interpreter).setErrorStr(&Error).create());
+    if (!Interpreter)
+    {
+        errs() << Error << "\n";
+        return 1;
+    }
+    tier_interpreter = Interpreter.get();
+    return Interpreter->runFunctionAsMain(main_function, args, nullptr);
+}
+
+// [hot reload]
+// each function is called through its stub, 'name' loads 'name.slot' and tail calls
+// the body stored there, 'name.v0' at first. a changed definition is compiled into
+// another module as 'name.v<version>' and stored into the slot, calls that are
+// already running finish in the old body.
+struct ReloadFunction
+{
+    size_t hash;      // of the definition's ast
+    std::string type; // a reload can't change the prototype
+    void **slot;
+};
+static std::map<std::string, ReloadFunction> reload_functions;
+static std::set<std::string> reload_globals;
+static unsigned reload_version;
+
+// the positions are left out, moving a definition doesn't change it
+static size_t hashNode(ast::Node *node)
+{
+    size_t res = std::hash<std::string>()(node->type) * 31 + std::hash<std::string>()(node->value);
+    for (auto &child : node->children)
+        res = res * 1000003 + hashNode(child.get());
+    return res;
+}
+static std::map<std::string, size_t> hashDefinitions(ast::Node *unit)
+{
+    std::map<std::string, size_t> res;
+    for (auto &child : unit->children)
+    {
+        if (child->type == "function_definition")
+            res[child->children[1]->getNameChild("identifier")->value] = hashNode(child.get());
+    }
+    return res;
+}
+static std::string typeName(Type *type)
+{
+    std::string res;
+    raw_string_ostream stream(res);
+    type->print(stream);
+    return stream.str();
+}
+
+// 'name' becomes the stub, the body is renamed to 'name.v<version>'
+static void addReloadStub(Function &function, unsigned version)
+{
+    auto &ctx = function.getContext();
+    auto parent = function.getParent();
+    auto name = function.getName().str();
+    function.setName(name + ".v" + std::to_string(version));
+    auto stub = Function::Create(function.getFunctionType(), GlobalValue::ExternalLinkage, name, parent);
+    function.replaceAllUsesWith(stub);
+    auto slot = new GlobalVariable(*parent, function.getType(), false, GlobalValue::ExternalLinkage, &function,
+                                   name + ".slot");
+
+    // an atomic load, the optimizer can't hoist it out of a loop of the caller
+    IRBuilder<> stub_builder(BasicBlock::Create(ctx, "entry", stub));
+    auto body = stub_builder.CreateLoad(function.getType(), slot, "body");
+    body->setAtomic(AtomicOrdering::Acquire);
+    body->setAlignment(parent->getDataLayout().getPointerABIAlignment(0));
+    std::vector<Value *> call_args;
+    for (auto &arg : stub->args())
+        call_args.push_back(&arg);
+    auto call = stub_builder.CreateCall(function.getFunctionType(), body, call_args);
+    call->setTailCallKind(CallInst::TCK_MustTail);
+    if (function.getReturnType()->isVoidTy())
+        stub_builder.CreateRetVoid();
+    else
+        stub_builder.CreateRet(call);
+}
+
+// cut 'module' down to what the running program doesn't have yet: changed bodies
+// are renamed, new functions get stubs, the rest become declarations of the symbols
+// already in the jit. the first module has nothing to compare to, all of it is new.
+static bool prepareReload(const std::map<std::string, size_t> &hashes, std::map<std::string, ReloadFunction> &added,
+                          std::vector<std::string> &changed)
+{
+    std::vector<Function *> new_functions, changed_functions, unchanged_functions;
+    for (auto &function : *module)
+    {
+        if (function.isDeclaration())
+            continue;
+        auto name = function.getName().str();
+        auto hash = hashes.count(name) ? hashes.at(name) : 0;
+        auto known = reload_functions.find(name);
+        if (known == reload_functions.end())
+        {
+            new_functions.push_back(&function);
+            added[name] = {hash, typeName(function.getFunctionType()), nullptr};
+        }
+        else if (known->second.type != typeName(function.getFunctionType()))
+        {
+            errs() << "[jit] the type of '" << name << "' changed, restart to reload it\n";
+            return false;
+        }
+        else if (known->second.hash != hash)
+        {
+            changed_functions.push_back(&function);
+            changed.push_back(name);
+        }
+        else
+            unchanged_functions.push_back(&function);
+    }
+    for (auto function : unchanged_functions)
+        function->deleteBody();
+    for (auto function : changed_functions)
+        function->setName(function->getName() + ".v" + std::to_string(reload_version));
+    for (auto function : new_functions)
+        addReloadStub(*function, reload_version);
+
+    // the slots and counters of the module keep their storage, new ones are defined here
+    for (auto &global : module->globals())
+    {
+        if (global.hasLocalLinkage() || global.isDeclaration())
+            continue;
+        if (reload_globals.count(global.getName().str()))
+        {
+            global.setInitializer(nullptr);
+            global.setLinkage(GlobalValue::ExternalLinkage);
+        }
+        else
+            reload_globals.insert(global.getName().str());
+    }
+    return true;
+}
+
+// the new bodies are compiled before any slot points at them
+static void commitReload(jit::Native &native, const std::map<std::string, size_t> &hashes,
+                         std::map<std::string, ReloadFunction> &added, const std::vector<std::string> &changed)
+{
+    for (auto &function : added)
+    {
+        function.second.slot = (void **)native.Lookup(function.first + ".slot");
+        reload_functions.insert(function);
+    }
+    for (auto &name : changed)
+    {
+        auto &function = reload_functions.at(name);
+        auto body = native.Lookup(name + ".v" + std::to_string(reload_version));
+        if (!body || !function.slot)
+            continue;
+        __atomic_store_n(function.slot, body, __ATOMIC_RELEASE);
+        function.hash = hashes.count(name) ? hashes.at(name) : 0;
+        errs() << "[jit] reloaded '" << name << "'\n";
+    }
+}
+
+static void reload(jit::Native &native, const std::function<std::shared_ptr<ast::Node>()> &rebuild)
+{
+    auto unit = rebuild();
+    if (!unit)
+    {
+        errs() << "[jit] reload failed, the running code is kept\n";
+        return;
+    }
+    ++reload_version;
+    auto hashes = hashDefinitions(unit.get());
+    std::map<std::string, ReloadFunction> added;
+    std::vector<std::string> changed;
+    if (!prepareReload(hashes, added, changed) || (added.empty() && changed.empty()))
+        return;
+    if (tc::optimize() || !native.Add(std::move(module), std::move(context)))
+    {
+        errs() << "[jit] reload failed, the running code is kept\n";
+        return;
+    }
+    commitReload(native, hashes, added, changed);
+}
+
+// polls the modification time, a save is picked up within the interval
+static void watchSource(jit::Native &native, const std::string &file,
+                        std::function<std::shared_ptr<ast::Node>()> rebuild, std::atomic<bool> &running)
+{
+    sys::fs::file_status status;
+    sys::fs::status(file, status);
+    auto modified = status.getLastModificationTime();
+    while (running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (sys::fs::status(file, status) || status.getLastModificationTime() == modified)
+            continue;
+        modified = status.getLastModificationTime();
+        reload(native, rebuild);
+    }
+}
+
+int jit::runReloadable(const std::vector<std::string> &args, std::shared_ptr<ast::Node> unit,
+                       std::function<std::shared_ptr<ast::Node>()> rebuild)
+{
+    auto hashes = hashDefinitions(unit.get());
+    std::map<std::string, ReloadFunction> added;
+    std::vector<std::string> changed;
+    prepareReload(hashes, added, changed);
+    if (tc::optimize())
+        return 1;
+    auto native = jit::Native::Create(std::move(module), std::move(context));
+    if (!native)
+        return 1;
+    auto main_function = (int (*)(int, char **))native->Lookup("main");
+    if (!main_function)
+        return 1;
+    commitReload(*native, hashes, added, changed);
+
+    // the parser and the generator only run on the watcher from here
+    std::atomic<bool> running(true);
+    std::thread watcher(watchSource, std::ref(*native), args[0], rebuild, std::ref(running));
+    std::vector<char *> argv;
+    for (auto &arg : args)
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    argv.push_back(nullptr);
+    auto res = main_function(args.size(), argv.data());
+    running = false;
+    watcher.join();
+    return res;
+}
\ No newline at end of file
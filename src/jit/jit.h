@@ -0,0 +1,60 @@
+#pragma once
+#include "../ast/ast.h"
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/GenericValue.h>
+#include <llvm/ExecutionEngine/Interpreter.h>
+#if LLVM_VERSION_MAJOR >= 8
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#else
+#include <llvm/ExecutionEngine/MCJIT.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/Mangler.h>
+#endif
+#include <llvm/IR/Module.h>
+#include <llvm/MC/SubtargetFeature.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+namespace jit
+{
+// native code for a whole module, compiled on the first lookup
+class Native
+{
+private:
+#if LLVM_VERSION_MAJOR >= 8
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+#else
+    std::vector<std::unique_ptr<llvm::LLVMContext>> contexts;
+    std::unique_ptr<llvm::ExecutionEngine> engine;
+#endif
+
+public:
+    // nullptr when the target can't jit
+    static std::unique_ptr<Native> Create(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
+    // another module, it links against the symbols of the ones before
+    bool Add(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context);
+    // a symbol the modules declare lives at address, e.g. a variable of the interpreter
+    bool Define(const std::string &name, void *address);
+    // address of a symbol the module defines, nullptr if it fails
+    void *Lookup(const std::string &name);
+};
+
+// '-run', compile the module in memory and call its main,
+// args[0] is the source file, the result is main's return value
+int run(const std::vector<std::string> &args);
+// '-run -ftiered', interpret first and run a function natively
+// once its calls and loop iterations reach threshold
+int runTiered(const std::vector<std::string> &args, uint64_t threshold);
+// '-run -fhot-reload', args[0] is watched while main runs, a function whose definition
+// changed is compiled again and its next calls go to the new body, the slots and the
+// '-fprofile-generate' counters keep their storage. rebuild parses and generates the source into 'module' again, nullptr on errors
+int runReloadable(const std::vector<std::string> &args, std::shared_ptr<ast::Node> unit,
+                  std::function<std::shared_ptr<ast::Node>()> rebuild);
+} // namespace jit
\ No newline at end of file
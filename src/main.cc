@@ -1,7 +1,11 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 #include <vector>
 
 #include "lib/json/json.h"
@@ -10,8 +14,12 @@
 #include "ast/ast.h"
 #include "ir/index.h"
 #include "ir/ir.h"
-#include "parser/parser.hh"
+#include "jit/jit.h"
+#include "ncc/ncc.h"
+#include "server/server.h"
 #include "tc/tc.h"
+#include "vm/compiler.h"
+#include "vm/vm.h"
 
 // #define _DEBUG_
 
@@ -20,104 +28,412 @@
 #define OUT_JSON (1 << 2)
 #define OUT_IR (1 << 3)
 #define OUT_OBJ (1 << 4)
+#define RUN_JIT (1 << 5)
+#define RUN_VM (1 << 6)
+#define OUT_BC (1 << 7)
 
 using namespace std;
 
-extern FILE *yyin;
-extern shared_ptr<ast::Node> root;
-extern bool parse_pass;
-std::string current_file;
 
-int main(int argc, char **argv)
+// one command line
+struct Invocation
 {
-#ifndef _DEBUG_
-    int _argc = argc;
-    char **_argv = argv;
-#else
-    int _argc = 5;
-    string _argv[5] = {"ncc", "test/function_definition/2.c", "-t=ir", "-t=json", "-t=obj"};
-#endif
-
     vector<string> source_files;
+    vector<string> run_args;
+    uint64_t tier_threshold = 0;
+    bool hot_reload = false;
     unsigned options = IN_C;
+    unsigned jobs = 1; // '-j N'
+    string server;     // '-server=socket'
+    string output;     // '-o file', the object of a single file or of '-flto'
+};
 
-    for (int i = 1; i < _argc; ++i)
+// the digits from offset on, std::stoull alone would take '-1' or '8x' and
+// throw on the rest, which a server mustn't
+static bool parseNumber(const string &term, size_t offset, unsigned long long &value)
+{
+    auto digits = term.substr(offset);
+    if (digits.empty() || digits.size() > 19 || digits.find_first_not_of("0123456789") != string::npos)
+    {
+        cerr << "'" << term << "' needs a number" << endl;
+        return false;
+    }
+    value = std::stoull(digits);
+    return true;
+}
+
+// false after printing the error
+static bool parseArguments(const vector<string> &arguments, Invocation &invocation)
+{
+    for (size_t i = 1; i < arguments.size(); ++i)
     {
-        string term(_argv[i]);
+        const string &term = arguments[i];
         if (term.length() < 2)
         {
             cerr << "unknown options" << endl;
-            exit(1);
+            return false;
         }
         if (term.at(0) == '-')
         {
-            if (term.at(1) == 't' && term.at(2) == '=')
+            if (term.substr(0, 3) == "-t=")
             {
                 std::string des_type = term.substr(3, term.size());
                 if (des_type == "json")
                 {
-                    options |= OUT_JSON;
+                    invocation.options |= OUT_JSON;
                 }
                 else if (des_type == "obj")
                 {
-                    options |= OUT_OBJ;
+                    invocation.options |= OUT_OBJ;
                 }
                 else if (des_type == "ir")
                 {
-                    options |= OUT_IR;
+                    invocation.options |= OUT_IR;
+                }
+                // the unit for a later '-flto' link, with '-flto=thin' with its summary
+                else if (des_type == "bc")
+                {
+                    invocation.options |= OUT_BC;
+                }
+            }
+            // '-j N' or '-jN', files compiled at the same time, '-j' alone for every core
+            else if (term.substr(0, 2) == "-j")
+            {
+                auto count = term;
+                if (count.size() == 2 && i + 1 < arguments.size() && isdigit(arguments[i + 1][0]))
+                    count += arguments[++i];
+                unsigned long long value = 0;
+                if (count.size() > 2 && !parseNumber(count, 2, value))
+                    return false;
+                invocation.jobs = count.size() == 2 ? std::max(std::thread::hardware_concurrency(), 1u)
+                                                    : std::max<unsigned>(value, 1);
+            }
+            else if (term == "-o")
+            {
+                if (i + 1 == arguments.size())
+                {
+                    cerr << "-o needs a file" << endl;
+                    return false;
+                }
+                invocation.output = arguments[++i];
+            }
+            // keep llvm set up and take the jobs of 'ncc-client' on this socket
+            else if (term.substr(0, 8) == "-server=")
+            {
+                invocation.server = term.substr(8);
+            }
+            // compile in memory and run, the arguments after the file go to its main
+            else if (term == "-run")
+            {
+                invocation.options |= RUN_JIT;
+            }
+            // run on the bytecode interpreter, llvm is never set up
+            else if (term == "-vm")
+            {
+                invocation.options |= RUN_VM;
+            }
+            // '-run' interprets first, compiling functions as they get hot
+            else if (term == "-ftiered")
+            {
+                invocation.tier_threshold = 1000;
+            }
+            else if (term.substr(0, 9) == "-ftiered=")
+            {
+                unsigned long long value;
+                if (!parseNumber(term, 9, value))
+                    return false;
+                invocation.tier_threshold = std::max(value, 1ull);
+            }
+            // '-run' keeps watching the source and swaps in the changed functions
+            else if (term == "-fhot-reload")
+            {
+                invocation.hot_reload = true;
+            }
+            // build ssa directly instead of alloca/load/store
+            else if (term == "-fssa")
+            {
+                codegen_options.ssa = true;
+            }
+            // budget of a compile-time call, in calls and loop iterations
+            else if (term.substr(0, 18) == "-fconstexpr-steps=")
+            {
+                unsigned long long value;
+                if (!parseNumber(term, 18, value))
+                    return false;
+                codegen_options.constexpr_steps = std::max(value, 1ull);
+            }
+            // the backend on N threads, one object merged from the parts or the parts
+            else if (term.substr(0, 19) == "-fparallel-codegen=")
+            {
+                unsigned long long value;
+                if (!parseNumber(term, 19, value))
+                    return false;
+                codegen_options.parallel_codegen = std::max<unsigned>(value, 1);
+            }
+            // function bodies lowered on N threads, linked into one module
+            else if (term.substr(0, 17) == "-fparallel-irgen=")
+            {
+                unsigned long long value;
+                if (!parseNumber(term, 17, value))
+                    return false;
+                codegen_options.parallel_irgen = std::max<unsigned>(value, 1);
+            }
+            // all files linked in memory and optimized as one program, or
+            // '-flto=thin' with summaries and a backend per file
+            else if (term == "-flto" || term == "-flto=full")
+            {
+                codegen_options.lto = ir::LTOFull;
+            }
+            else if (term == "-flto=thin")
+            {
+                codegen_options.lto = ir::LTOThin;
+            }
+            else if (term.substr(0, 11) == "-flto-jobs=")
+            {
+                unsigned long long value;
+                if (!parseNumber(term, 11, value))
+                    return false;
+                codegen_options.lto_jobs = value;
+            }
+            else if (term.substr(0, 12) == "-flto-cache=")
+            {
+                codegen_options.lto_cache = term.substr(12);
+            }
+            else if (term.substr(0, 9) == "-fexport=")
+            {
+                std::stringstream names(term.substr(9));
+                std::string name;
+                while (std::getline(names, name, ','))
+                {
+                    if (!name.empty())
+                        codegen_options.exports.push_back(name);
+                }
+            }
+            else if (term == "-fsplit-objects")
+            {
+                codegen_options.split_objects = true;
+            }
+            else if (term == "-fwrapv")
+            {
+                codegen_options.wrapv = true;
+            }
+            // floating point
+            else if (term == "-ffast-math")
+            {
+                codegen_options.fast_math = true;
+                codegen_options.fp_contract = ir::FPContractFast;
+            }
+            else if (term == "-fno-signed-zeros")
+            {
+                codegen_options.no_signed_zeros = true;
+            }
+            else if (term == "-freciprocal-math")
+            {
+                codegen_options.reciprocal_math = true;
+            }
+            else if (term.substr(0, 14) == "-ffp-contract=")
+            {
+                std::string mode = term.substr(14);
+                if (mode == "off")
+                    codegen_options.fp_contract = ir::FPContractOff;
+                else if (mode == "on")
+                    codegen_options.fp_contract = ir::FPContractOn;
+                else if (mode == "fast")
+                    codegen_options.fp_contract = ir::FPContractFast;
+                else
+                {
+                    cerr << "unknown -ffp-contract mode: " << mode << endl;
+                    return false;
+                }
+            }
+            // target cpu, '-march=native' for the host
+            else if (term.substr(0, 7) == "-march=" || term.substr(0, 6) == "-mcpu=")
+            {
+                codegen_options.cpu = term.substr(term.find('=') + 1);
+            }
+            else if (term.substr(0, 7) == "-mattr=")
+            {
+                auto features = term.substr(7);
+                codegen_options.features += codegen_options.features.empty() ? features : "," + features;
+            }
+            else if (term.substr(0, 7) == "-mtune=")
+            {
+                codegen_options.tune_cpu = term.substr(7);
+            }
+            // copies of every function for these features, picked at load time
+            else if (term.substr(0, 15) == "-fmultiversion=")
+            {
+                std::stringstream features(term.substr(15));
+                std::string feature;
+                while (std::getline(features, feature, ','))
+                {
+                    if (!feature.empty())
+                        codegen_options.multiversion.push_back(feature);
+                }
+            }
+            // instrument with counters, or optimize with the merged counts
+            else if (term == "-fprofile-generate")
+            {
+                codegen_options.profile_generate = "default.profraw";
+            }
+            else if (term.substr(0, 19) == "-fprofile-generate=")
+            {
+                codegen_options.profile_generate = term.substr(19) + "/default.profraw";
+            }
+            else if (term.substr(0, 14) == "-fprofile-use=")
+            {
+                codegen_options.profile_use = term.substr(14);
+            }
+            // optimization level, '-Os'/'-Oz' optimize like '-O2' but for size
+            else if (term.at(1) == 'O')
+            {
+                std::string level = term.substr(2);
+                if (level == "0" || level == "1" || level == "2" || level == "3")
+                {
+                    codegen_options.opt_level = level.at(0) - '0';
+                    codegen_options.size_level = 0;
+                }
+                else if (level == "s" || level == "z")
+                {
+                    codegen_options.opt_level = 2;
+                    codegen_options.size_level = level == "s" ? 1 : 2;
+                }
+                else
+                {
+                    cerr << "unknown optimization level: " << term << endl;
+                    return false;
                 }
             }
         }
         else
         {
-            source_files.emplace_back(term);
+            invocation.source_files.emplace_back(term);
+            if (invocation.options & (RUN_JIT | RUN_VM))
+            {
+                invocation.run_args.assign(arguments.begin() + i, arguments.end());
+                break;
+            }
         }
     }
+    return true;
+}
+
+static int compileParallel(const Invocation &invocation);
+static int compileLTO(const Invocation &invocation);
+
+// the whole file, sources are compiled from memory
+static bool readSource(const string &file, string &source)
+{
+    ifstream in(file, ios::binary);
+    if (!in.is_open())
+        return false;
+    stringstream text;
+    text << in.rdbuf();
+    source = text.str();
+    return true;
+}
+
+static int compile(const Invocation &invocation)
+{
+    // set up the target before '-j' forks, '-vm' never loads one
+    if (!(invocation.options & RUN_VM))
+        tc::getTargetMachine();
+    if (codegen_options.lto && !(invocation.options & (RUN_VM | OUT_BC)))
+        return compileLTO(invocation);
+    if (invocation.jobs > 1 && invocation.source_files.size() > 1)
+        return compileParallel(invocation);
 
     Json::StyledStreamWriter writer(" ");
 
     // c to obj
-    if ((options & IN_C))
+    if ((invocation.options & IN_C))
     {
-        for (auto &file : source_files)
+        for (auto &file : invocation.source_files)
         {
-            current_file = file;
             string wo_ext = file.substr(0, file.find_last_of('.'));
+            ncc::CompilerInstance instance;
+            instance.options = codegen_options;
+            instance.name = file;
 
             // Parse AST from C code
-            yyin = fopen(file.c_str(), "r");
-            if (yyin == NULL)
+            string source;
+            if (!readSource(file, source))
             {
                 cerr << "Cannot open file" << file << endl;
                 continue;
             }
-            yyparse();
-            fclose(yyin);
-            if (!parse_pass)
+            if (!instance.Parse(source))
             {
                 exit(1);
             }
-            if (options & OUT_JSON)
+            if (invocation.options & OUT_JSON)
             {
                 ofstream ast_file(wo_ext + ".json");
-                writer.write(ast_file, ast::exports(root));
+                writer.write(ast_file, ast::exports(instance.ast));
                 ast_file.close();
             }
 
+            // Compile AST to bytecode and run it
+            if (invocation.options & RUN_VM)
+            {
+                vm::Program program;
+                if (!vm::Compiler().Compile(instance.ast.get(), program))
+                {
+                    cerr << "\n[main] error when generate bytecode.\n";
+                    return 1;
+                }
+                return vm::run(program, invocation.run_args);
+            }
+
             // Generate IR form AST
-            auto res = generator.Generate(root);
+            auto res = instance.Generate();
             if (!res)
             {
                 cerr << "\n[main] error when generate ir.\n";
-                return 0;
+                return 1;
+            }
+            // Run the module, changed functions are reloaded while it runs
+            if ((invocation.options & RUN_JIT) && invocation.hot_reload)
+            {
+                // on the watcher thread, with the options of this one
+                auto options = instance.options;
+                auto rebuild = [file, options]() -> shared_ptr<ast::Node> {
+                    ncc::CompilerInstance again;
+                    again.options = options;
+                    again.name = file;
+                    string source;
+                    if (!readSource(file, source) || !again.Parse(source) || !again.Generate())
+                        return nullptr;
+                    return again.ast;
+                };
+                return jit::runReloadable(invocation.run_args, instance.ast, rebuild);
+            }
+            // Optimize IR, both the ir file and the object see the result
+            if (!instance.Optimize())
+            {
+                cerr << "\n[main] error when optimize ir.\n";
+                return 1;
+            }
+            if (invocation.options & OUT_BC)
+            {
+                llvm::SmallString<0> bitcode;
+                instance.Bitcode(bitcode);
+                auto unit = invocation.output.empty() || invocation.source_files.size() > 1 ? wo_ext + ".bc"
+                                                                                           : invocation.output;
+                ofstream bc_file(unit, ios::binary);
+                bc_file << bitcode.str().str();
+                continue;
+            }
+            // Run the module, nothing is written
+            if (invocation.options & RUN_JIT)
+            {
+                return invocation.tier_threshold ? jit::runTiered(invocation.run_args, invocation.tier_threshold)
+                                                  : jit::run(invocation.run_args);
             }
             // Save IR to file
-            if (options & OUT_IR)
+            if (invocation.options & OUT_IR)
             {
-                string ir_code;
-                llvm::raw_string_ostream ros(ir_code);
-                ros << *module;
-                ros.flush();
+                string ir_code = instance.IR();
                 std::cout << "\n[main] Generated IR:\n" + ir_code << std::endl;
                 ofstream ir_file(wo_ext + ".ll");
                 ir_file << ir_code;
@@ -125,13 +441,15 @@ int main(int argc, char **argv)
             }
 
             // Generate target code from IR
-            if (options & OUT_OBJ)
+            if (invocation.options & OUT_OBJ)
             {
-                ofstream tc_file(wo_ext + ".o");
-                if (tc::targetGenerate(wo_ext + ".o"))
+                auto object = invocation.output.empty() || invocation.source_files.size() > 1 ? wo_ext + ".o"
+                                                                                             : invocation.output;
+                ofstream tc_file(object);
+                if (tc::targetGenerate(object))
                 {
                     cout << "\n[main] error when generate target code.\n";
-                    return 0;
+                    return 1;
                 }
                 tc_file.flush();
                 tc_file.close();
@@ -141,3 +459,202 @@ int main(int argc, char **argv)
 
     return 0;
 }
+
+// '-flto', every file goes through the first half of the pipeline on its own and is
+// kept as bitcode, then they are linked in memory and optimized as one program:
+// what is not exported becomes internal, small functions inline across files. one
+// object, '-o' or named after the first file. '.bc' files from '-t=bc' join as they
+// are, '-flto=thin' links their summaries and runs a backend per unit instead
+static int compileLTO(const Invocation &invocation)
+{
+    std::vector<std::pair<string, llvm::SmallString<0>>> units;
+    for (auto &file : invocation.source_files)
+    {
+        ncc::CompilerInstance instance;
+        instance.options = codegen_options;
+        instance.name = file;
+        string source;
+        if (!readSource(file, source))
+        {
+            cerr << "Cannot open file" << file << endl;
+            return 1;
+        }
+        if (file.size() > 3 && file.substr(file.size() - 3) == ".bc")
+        {
+            units.emplace_back(file, llvm::SmallString<0>(source));
+            continue;
+        }
+        if (!instance.Parse(source))
+            return 1;
+        if (!instance.Generate())
+        {
+            cerr << "\n[main] error when generate ir.\n";
+            return 1;
+        }
+        units.emplace_back(file, llvm::SmallString<0>());
+        if (!instance.Optimize() || !instance.Bitcode(units.back().second))
+        {
+            cerr << "\n[main] error when optimize ir.\n";
+            return 1;
+        }
+    }
+    if (units.empty())
+        return 0;
+    auto &first = invocation.source_files[0];
+    auto object = invocation.output.empty() ? first.substr(0, first.find_last_of('.')) + ".o" : invocation.output;
+    if (codegen_options.lto == ir::LTOThin)
+    {
+        if (invocation.options & (RUN_JIT | OUT_IR))
+        {
+            cerr << "-flto=thin keeps no module of the program, -run and -t=ir need -flto\n";
+            return 1;
+        }
+        return (invocation.options & OUT_OBJ) && tc::thinLink(units, object) ? 1 : 0;
+    }
+    if (tc::linkUnits(units) || tc::optimizeLTO())
+    {
+        cerr << "\n[main] error when link the units.\n";
+        return 1;
+    }
+
+    if (invocation.options & RUN_JIT)
+    {
+        return invocation.tier_threshold ? jit::runTiered(invocation.run_args, invocation.tier_threshold)
+                                          : jit::run(invocation.run_args);
+    }
+    if (invocation.options & OUT_IR)
+    {
+        string ir_code;
+        llvm::raw_string_ostream stream(ir_code);
+        stream << *module;
+        stream.flush();
+        std::cout << "\n[main] Generated IR:\n" + ir_code << std::endl;
+        ofstream ir_file(object.substr(0, object.find_last_of('.')) + ".ll");
+        ir_file << ir_code;
+    }
+    if ((invocation.options & OUT_OBJ) && tc::targetGenerate(object))
+    {
+        cout << "\n[main] error when generate target code.\n";
+        return 1;
+    }
+    return 0;
+}
+
+// '-j N', each file is compiled by a process of its own, at most N at a time. the
+// parser and the generator keep their state in globals, a process per translation
+// unit gives each one its own context, module, symbol tables and parser. they fork
+// after the target machine is set up. the output of a file is held back and printed
+// as a whole, in the order of the files, the result is the first failure
+static int compileParallel(const Invocation &invocation)
+{
+    struct Unit
+    {
+        pid_t pid = -1;
+        FILE *out = nullptr;
+        FILE *err = nullptr;
+        int status = -1;
+    };
+    std::vector<Unit> units(invocation.source_files.size());
+    size_t next = 0, printed = 0, running = 0;
+    int res = 0;
+    cout.flush();
+    llvm::outs().flush();
+    fflush(nullptr);
+    while (printed < units.size())
+    {
+        for (; running < invocation.jobs && next < units.size(); ++next)
+        {
+            auto &unit = units[next];
+            unit.out = tmpfile();
+            unit.err = tmpfile();
+            Invocation single = invocation;
+            single.source_files = {invocation.source_files[next]};
+            single.jobs = 1;
+            // '-o' names the output of a single file, with more each is named after its file
+            if (invocation.source_files.size() > 1)
+                single.output.clear();
+            unit.pid = unit.out && unit.err ? fork() : -1;
+            if (unit.pid == 0)
+            {
+                dup2(fileno(unit.out), 1);
+                dup2(fileno(unit.err), 2);
+                exit(compile(single));
+            }
+            if (unit.pid < 0)
+            {
+                cerr << "[main] can't start a job for " << single.source_files[0] << endl;
+                unit.status = 1;
+            }
+            else
+                ++running;
+        }
+        int status = 0;
+        auto pid = running ? wait(&status) : -1;
+        for (auto &unit : units)
+        {
+            if (pid > 0 && unit.pid == pid)
+            {
+                unit.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                --running;
+            }
+        }
+        for (; printed < next && units[printed].status >= 0; ++printed)
+        {
+            auto &unit = units[printed];
+            char buffer[4096];
+            size_t size;
+            for (auto stream : {std::make_pair(unit.out, stdout), std::make_pair(unit.err, stderr)})
+            {
+                if (!stream.first)
+                    continue;
+                rewind(stream.first);
+                while ((size = fread(buffer, 1, sizeof(buffer), stream.first)))
+                    fwrite(buffer, 1, size, stream.second);
+                fflush(stream.second);
+                fclose(stream.first);
+            }
+            if (!res)
+                res = unit.status;
+        }
+    }
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+#ifndef _DEBUG_
+    vector<string> arguments(argv, argv + argc);
+#else
+    vector<string> arguments = {"ncc", "test/function_definition/2.c", "-t=ir", "-t=json", "-t=obj"};
+#endif
+
+    Invocation invocation;
+    if (!parseArguments(arguments, invocation))
+        exit(1);
+    if (invocation.server.empty())
+        return compile(invocation);
+
+    // the machine of a job is created before it forks, the jobs after it with the
+    // same options find it ready. parsing sets globals, the server keeps its own
+    auto prepare = [](const vector<string> &arguments) {
+        auto saved_options = codegen_options;
+        auto saved_cerr = cerr.rdbuf(nullptr);
+        codegen_options = ir::Options();
+        Invocation job;
+        if (parseArguments(arguments, job) && !(job.options & RUN_VM))
+            tc::getTargetMachine();
+        cerr.rdbuf(saved_cerr);
+        cerr.clear();
+        codegen_options = saved_options;
+    };
+    // runs in the job's process with its working directory and streams, a job starts
+    // from the default options and not from the server's own flags
+    auto run = [](const vector<string> &arguments) {
+        codegen_options = ir::Options();
+        Invocation job;
+        if (!parseArguments(arguments, job))
+            return 1;
+        return compile(job);
+    };
+    return server::serve(invocation.server, prepare, run);
+}
@@ -0,0 +1,121 @@
+#include "ncc.h"
+#include "../ir/ir.h"
+#include "../parser/parser.hh"
+#include "../tc/tc.h"
+#include "../util/prettyPrint.h"
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+#include <llvm/Analysis/ProfileSummaryInfo.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <mutex>
+
+extern std::shared_ptr<ast::Node> root;
+extern bool parse_pass;
+void *scan_begin(const std::string &source);
+void scan_end(void *buffer);
+
+// the flex scanner and the bison parser keep their state in globals,
+// one parse at a time, everything after it runs in parallel
+static std::mutex parser_lock;
+
+// the thread's compile takes the options and diagnostics of this instance
+void ncc::CompilerInstance::Bind()
+{
+    codegen_options = this->options;
+    pretty::file = this->name;
+    pretty::source = &this->source;
+    pretty::err = this->diagnostics;
+    pretty::out = this->log;
+}
+
+// diagnostics after it is gone read the file again
+ncc::CompilerInstance::~CompilerInstance()
+{
+    if (pretty::source == &this->source)
+        pretty::source = nullptr;
+}
+
+bool ncc::CompilerInstance::Parse(const std::string &source)
+{
+    this->source = source;
+    this->Bind();
+    std::lock_guard<std::mutex> lock(parser_lock);
+    auto buffer = scan_begin(this->source);
+    parse_pass = true;
+    root = nullptr;
+    yyparse();
+    scan_end(buffer);
+    this->ast = parse_pass ? root : nullptr;
+    root = nullptr;
+    return this->ast != nullptr;
+}
+
+bool ncc::CompilerInstance::Generate()
+{
+    if (!this->ast)
+        return false;
+    // ir against the layout of the target
+    this->Bind();
+    auto machine = tc::getTargetMachine();
+    if (!machine)
+        return false;
+    codegen_options.target_triple = machine->getTargetTriple().str();
+    codegen_options.data_layout = machine->createDataLayout().getStringRepresentation();
+    return generator.Generate(this->ast);
+}
+
+bool ncc::CompilerInstance::Optimize()
+{
+    if (!module)
+        return false;
+    this->Bind();
+    return !tc::optimize();
+}
+
+std::string ncc::CompilerInstance::IR()
+{
+    std::string res;
+    if (!module)
+        return res;
+    llvm::raw_string_ostream stream(res);
+    stream << *module;
+    stream.flush();
+    return res;
+}
+
+bool ncc::CompilerInstance::Bitcode(llvm::SmallVectorImpl<char> &bitcode)
+{
+    if (!module)
+        return false;
+    this->Bind();
+    llvm::raw_svector_ostream stream(bitcode);
+    // '-flto=thin', with the summary and the hash the thin link and its cache look at
+    std::unique_ptr<llvm::ModuleSummaryIndex> summary;
+    if (codegen_options.lto == ir::LTOThin)
+    {
+        llvm::ProfileSummaryInfo profile(*module);
+        summary.reset(new llvm::ModuleSummaryIndex(llvm::buildModuleSummaryIndex(*module, nullptr, &profile)));
+    }
+#if LLVM_VERSION_MAJOR >= 7
+    llvm::WriteBitcodeToFile(*module, stream, false, summary.get(), summary != nullptr);
+#else
+    llvm::WriteBitcodeToFile(module.get(), stream, false, summary.get(), summary != nullptr);
+#endif
+    return true;
+}
+
+bool ncc::CompilerInstance::Object(llvm::SmallVectorImpl<char> &object)
+{
+    if (!module)
+        return false;
+    this->Bind();
+    llvm::raw_svector_ostream stream(object);
+    return !tc::emitObject(stream);
+}
+
+bool ncc::CompilerInstance::Objects(std::vector<llvm::SmallString<0>> &objects)
+{
+    if (!module)
+        return false;
+    this->Bind();
+    return !tc::emitObjects(objects);
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include "../ast/ast.h"
+#include "../ir/global.h"
+#include <iostream>
+#include <llvm/ADT/SmallVector.h>
+#include <memory>
+#include <string>
+namespace ncc
+{
+// one translation unit from source text in memory to its ast, ir or object code,
+// nothing is read from or written to the filesystem. the state of a compile
+// (context, module, symbol tables, target machine) belongs to the calling thread,
+// instances on different threads compile at the same time. a thread works on one
+// instance at a time, its next Generate replaces the module of the one before
+class CompilerInstance
+{
+private:
+    std::string source;
+
+    void Bind();
+
+public:
+    ~CompilerInstance();
+
+    ir::Options options;                    // what the command line sets, '-O2', '-march=', ...
+    std::string name = "<source>";          // the file in the diagnostics
+    std::ostream *diagnostics = &std::cerr; // errors and warnings with their source line
+    std::ostream *log = &std::cout;         // progress notes of the generator
+    std::shared_ptr<ast::Node> ast;         // after Parse
+
+    // each step needs the ones before it, false after the diagnostics
+    bool Parse(const std::string &source);
+    bool Generate();
+    bool Optimize();
+    // the module as text
+    std::string IR();
+    // the module as bitcode, what '-flto' links, with its summary for '-flto=thin'
+    bool Bitcode(llvm::SmallVectorImpl<char> &bitcode);
+    // the object file for the target, appended to object
+    bool Object(llvm::SmallVectorImpl<char> &object);
+    // with '-fparallel-codegen=N' in the options, an object per part, compiled
+    // on N threads, the caller links them together
+    bool Objects(std::vector<llvm::SmallString<0>> &objects);
+};
+} // namespace ncc
\ No newline at end of file
@@ -27,7 +27,7 @@ static std::string msg;
 %token XOR_ASSIGN OR_ASSIGN
 
 %token TYPEDEF EXTERN STATIC AUTO REGISTER
-%token CHAR SHORT INT LONG SIGNED UNSIGNED FLOAT DOUBLE CONST VOLATILE VOID
+%token CHAR SHORT INT LONG SIGNED UNSIGNED FLOAT DOUBLE CONST VOLATILE RESTRICT VOID
 %token STRUCT UNION ENUM ELLIPSIS
 
 %token CASE DEFAULT IF ELSE SWITCH WHILE DO FOR GOTO CONTINUE BREAK RETURN
@@ -764,6 +764,10 @@ type_qualifier
 	$$ = $1;
 	$$->type = "type_qualifier";
 }
+| RESTRICT	{
+	$$ = $1;
+	$$->type = "type_qualifier";
+}
 ;
 
 declarator
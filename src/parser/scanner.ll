@@ -54,6 +54,7 @@ e_float			({num}|{float_num})[eE][+-]?{num}
 "int"			{yylval = std::make_shared<ast::Node>("int"		,	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return INT; }
 "long"			{yylval = std::make_shared<ast::Node>("long"	,	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return LONG; }
 "register"		{yylval = std::make_shared<ast::Node>("register",	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return REGISTER; }
+"restrict"		{yylval = std::make_shared<ast::Node>("restrict",	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return RESTRICT; }
 "return"		{yylval = std::make_shared<ast::Node>("return"	,	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return RETURN; }
 "short"			{yylval = std::make_shared<ast::Node>("short"	,	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return SHORT; }
 "signed"		{yylval = std::make_shared<ast::Node>("signed"	,	yytext, yylineno, ypos, yylineno, ypos+yyleng); ypos+=yyleng; return SIGNED; }
@@ -140,6 +141,18 @@ int yywrap()
 	return(1);
 }
 
+// yyparse reads source instead of yyin until scan_end
+void *scan_begin(const std::string &source)
+{
+	yylineno = 1;
+	ypos = 0;
+	return yy_scan_bytes(source.data(), source.size());
+}
+void scan_end(void *buffer)
+{
+	yy_delete_buffer((YY_BUFFER_STATE)buffer);
+}
+
 inline std::string hex2num()
 {
 	unsigned long res = 0;
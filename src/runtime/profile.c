@@ -0,0 +1,88 @@
+// the part of compiler-rt's profile runtime that '-fprofile-generate' needs:
+// write the counters of the program to a .profraw for llvm-profdata at exit.
+// link the program with libncc_profile.a, LLVM_PROFILE_FILE overrides the path.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef void *IntPtrT;
+// the constants, the format itself below
+#include <llvm/ProfileData/InstrProfData.inc>
+
+enum ValueKind
+{
+#define VALUE_PROF_KIND(Enumerator, Value, ...) Enumerator = Value,
+#include <llvm/ProfileData/InstrProfData.inc>
+};
+
+typedef struct
+{
+#define INSTR_PROF_DATA(Type, LLVMType, Name, Initializer) Type Name;
+#include <llvm/ProfileData/InstrProfData.inc>
+} ProfileData;
+
+typedef struct
+{
+#define INSTR_PROF_RAW_HEADER(Type, Name, Initializer) Type Name;
+#include <llvm/ProfileData/InstrProfData.inc>
+} ProfileHeader;
+
+// the layout below, header, data, counters, names
+#if INSTR_PROF_RAW_VERSION != 4
+#error "unsupported raw profile version"
+#endif
+
+// the linker bounds the sections the instrumented code puts its records in
+extern ProfileData __start___llvm_prf_data[] __attribute__((visibility("hidden")));
+extern ProfileData __stop___llvm_prf_data[] __attribute__((visibility("hidden")));
+extern uint64_t __start___llvm_prf_cnts[] __attribute__((visibility("hidden")));
+extern uint64_t __stop___llvm_prf_cnts[] __attribute__((visibility("hidden")));
+extern char __start___llvm_prf_names[] __attribute__((visibility("hidden")));
+extern char __stop___llvm_prf_names[] __attribute__((visibility("hidden")));
+
+// the instrumented module defines the real ones
+__attribute__((weak)) const uint64_t __llvm_profile_raw_version = INSTR_PROF_RAW_VERSION;
+extern const char __llvm_profile_filename[] __attribute__((weak));
+
+// referenced by every instrumented module, pulls this file out of the archive
+int __llvm_profile_runtime;
+
+static void write_profile(void)
+{
+    const char *filename = getenv("LLVM_PROFILE_FILE");
+    if (!filename || !*filename)
+        filename = __llvm_profile_filename && *__llvm_profile_filename ? __llvm_profile_filename : "default.profraw";
+
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "profile: cannot open %s\n", filename);
+        return;
+    }
+    uint64_t names_size = __stop___llvm_prf_names - __start___llvm_prf_names;
+    ProfileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = INSTR_PROF_RAW_MAGIC_64;
+    header.Version = __llvm_profile_raw_version;
+    header.DataSize = __stop___llvm_prf_data - __start___llvm_prf_data;
+    header.CountersSize = __stop___llvm_prf_cnts - __start___llvm_prf_cnts;
+    header.NamesSize = names_size;
+    header.CountersDelta = (uintptr_t)__start___llvm_prf_cnts;
+    header.NamesDelta = (uintptr_t)__start___llvm_prf_names;
+    header.ValueKindLast = IPVK_Last;
+
+    // the names are padded to 8 bytes, no value profile data follows
+    static const char padding[8];
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(__start___llvm_prf_data, sizeof(ProfileData), header.DataSize, file);
+    fwrite(__start___llvm_prf_cnts, sizeof(uint64_t), header.CountersSize, file);
+    fwrite(__start___llvm_prf_names, 1, names_size, file);
+    fwrite(padding, 1, (8 - names_size % 8) % 8, file);
+    fclose(file);
+}
+
+__attribute__((constructor)) static void register_profile(void)
+{
+    atexit(write_profile);
+}
@@ -0,0 +1,26 @@
+#include "protocol.h"
+#include <cstdio>
+#include <cstdlib>
+
+// ncc-client, the command line of ncc compiled by the server on $NCC_SERVER
+// ('ncc -server=path'). it links nothing of llvm, starting it is cheap
+int main(int argc, char **argv)
+{
+    auto path = getenv("NCC_SERVER");
+    if (!path)
+        path = (char *)server::default_socket;
+    int connection = server::connectTo(path);
+    if (connection < 0)
+    {
+        fprintf(stderr, "[client] no server on %s, start one with 'ncc -server=%s'\n", path, path);
+        return 1;
+    }
+    int status = 1;
+    if (!server::sendJob(connection, std::vector<std::string>(argv, argv + argc)) ||
+        !server::receiveStatus(connection, status))
+    {
+        fprintf(stderr, "[client] the server on %s went away\n", path);
+        return 1;
+    }
+    return status;
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "protocol.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// [wire]
+// sendmsg with a uint32 size, a uint32 count of arguments and the three
+// descriptors as SCM_RIGHTS, then size bytes of NUL terminated strings: the
+// directory first, the arguments after it, the environment last.
+// the answer is an int32 exit code.
+
+static bool address(const std::string &path, sockaddr_un &res)
+{
+    memset(&res, 0, sizeof(res));
+    res.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(res.sun_path))
+        return false;
+    strcpy(res.sun_path, path.c_str());
+    return true;
+}
+static bool writeAll(int connection, const char *data, size_t size)
+{
+    while (size)
+    {
+        auto written = write(connection, data, size);
+        if (written <= 0)
+            return false;
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+static bool readAll(int connection, char *data, size_t size)
+{
+    while (size)
+    {
+        auto got = read(connection, data, size);
+        if (got <= 0)
+            return false;
+        data += got;
+        size -= got;
+    }
+    return true;
+}
+
+int server::listenOn(const std::string &path)
+{
+    sockaddr_un server_address;
+    if (!address(path, server_address))
+        return -1;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return -1;
+    // a socket left behind by a server that was killed, anything else at the
+    // path is left alone and bind fails on it
+    struct stat status;
+    if (lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+        unlink(path.c_str());
+    if (bind(listener, (sockaddr *)&server_address, sizeof(server_address)) || listen(listener, SOMAXCONN))
+    {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+int server::connectTo(const std::string &path)
+{
+    sockaddr_un server_address;
+    if (!address(path, server_address))
+        return -1;
+    int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0)
+        return -1;
+    if (connect(connection, (sockaddr *)&server_address, sizeof(server_address)))
+    {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+bool server::sendJob(int connection, const std::vector<std::string> &arguments)
+{
+    char directory[PATH_MAX];
+    if (!getcwd(directory, sizeof(directory)))
+        return false;
+    std::string payload(directory, strlen(directory) + 1);
+    for (auto &argument : arguments)
+        payload.append(argument.c_str(), argument.size() + 1);
+    for (auto variable = environ; *variable; ++variable)
+        payload.append(*variable, strlen(*variable) + 1);
+
+    uint32_t size[2] = {uint32_t(payload.size()), uint32_t(arguments.size())};
+    iovec header = {size, sizeof(size)};
+    int fds[3] = {0, 1, 2};
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &header;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    auto fd_message = CMSG_FIRSTHDR(&message);
+    fd_message->cmsg_level = SOL_SOCKET;
+    fd_message->cmsg_type = SCM_RIGHTS;
+    fd_message->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(fd_message), fds, sizeof(fds));
+    if (sendmsg(connection, &message, 0) != sizeof(size))
+        return false;
+    return writeAll(connection, payload.data(), payload.size());
+}
+bool server::receiveJob(int connection, Job &job)
+{
+    uint32_t size[2] = {0, 0};
+    iovec header = {size, sizeof(size)};
+    char control[CMSG_SPACE(sizeof(job.fds))];
+    msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &header;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    if (recvmsg(connection, &message, 0) != sizeof(size))
+        return false;
+    auto fd_message = CMSG_FIRSTHDR(&message);
+    if (!fd_message || fd_message->cmsg_type != SCM_RIGHTS || fd_message->cmsg_len != CMSG_LEN(sizeof(job.fds)))
+        return false;
+    memcpy(job.fds, CMSG_DATA(fd_message), sizeof(job.fds));
+
+    std::string payload(size[0], '\0');
+    if (!readAll(connection, &payload[0], size[0]) || payload.empty() || payload.back() != '\0')
+    {
+        for (auto fd : job.fds)
+            close(fd);
+        return false;
+    }
+    for (size_t begin = 0, end; begin < payload.size(); begin = end + 1)
+    {
+        end = payload.find('\0', begin);
+        if (begin == 0)
+            job.directory = payload.substr(0, end);
+        else if (job.arguments.size() < size[1])
+            job.arguments.push_back(payload.substr(begin, end - begin));
+        else
+            job.environment.push_back(payload.substr(begin, end - begin));
+    }
+    return true;
+}
+
+bool server::sendStatus(int connection, int status)
+{
+    int32_t code = status;
+    return writeAll(connection, (const char *)&code, sizeof(code));
+}
+bool server::receiveStatus(int connection, int &status)
+{
+    int32_t code = 0;
+    if (!readAll(connection, (char *)&code, sizeof(code)))
+        return false;
+    status = code;
+    return true;
+}
\ No newline at end of file
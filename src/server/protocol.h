@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+namespace server
+{
+// a job is an ncc command line, the client's working directory, its environment
+// ($LD, $TMPDIR...) and its stdin, stdout and stderr passed as descriptors, the
+// server writes to the client's terminal or pipes directly. the exit code of
+// the compile goes back.
+struct Job
+{
+    std::string directory;
+    std::vector<std::string> arguments;
+    std::vector<std::string> environment; // 'NAME=value'
+    int fds[3] = {-1, -1, -1};
+};
+
+// the socket of 'ncc-client' when $NCC_SERVER isn't set
+const char *const default_socket = "/tmp/ncc.sock";
+
+// -1 on errors, errno tells why
+int listenOn(const std::string &path);
+int connectTo(const std::string &path);
+// the client sends its own directory, environment and descriptors 0, 1 and 2
+bool sendJob(int connection, const std::vector<std::string> &arguments);
+bool receiveJob(int connection, Job &job);
+bool sendStatus(int connection, int status);
+bool receiveStatus(int connection, int &status);
+} // namespace server
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "server.h"
+#include "../tc/tc.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// the job's own process, forks again for the compile to learn how it ended
+static int runJob(int connection, server::Job &job, const std::function<int(const server::Arguments &)> &run)
+{
+    signal(SIGCHLD, SIG_DFL);
+    auto compile = fork();
+    if (compile == 0)
+    {
+        for (int fd = 0; fd < 3; ++fd)
+        {
+            dup2(job.fds[fd], fd);
+            close(job.fds[fd]);
+        }
+        close(connection);
+        if (chdir(job.directory.c_str()))
+        {
+            perror("[server] chdir");
+            _exit(1);
+        }
+        // the client's environment, not the server's, e.g. $LD for the link
+        clearenv();
+        for (auto &variable : job.environment)
+        {
+            auto equals = variable.find('=');
+            if (equals != std::string::npos)
+                setenv(variable.substr(0, equals).c_str(), variable.substr(equals + 1).c_str(), 1);
+        }
+        exit(run(job.arguments));
+    }
+    for (auto fd : job.fds)
+        close(fd);
+    int status = 0, code = 1;
+    if (compile > 0 && waitpid(compile, &status, 0) == compile)
+        code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    server::sendStatus(connection, code);
+    return 0;
+}
+
+int server::serve(const std::string &path, std::function<void(const Arguments &)> prepare,
+                  std::function<int(const Arguments &)> run)
+{
+    int listener = server::listenOn(path);
+    if (listener < 0)
+    {
+        perror(("[server] " + path).c_str());
+        return 1;
+    }
+    // the targets are registered once, every job after this starts from here
+    tc::initializeTargets();
+    // finished jobs are reaped by the kernel
+    signal(SIGCHLD, SIG_IGN);
+    std::cerr << "[server] listening on " << path << std::endl;
+
+    while (true)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+        if (connection < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("[server] accept");
+            return 1;
+        }
+        Job job;
+        if (server::receiveJob(connection, job))
+        {
+            prepare(job.arguments);
+            std::cout.flush();
+            if (fork() == 0)
+            {
+                close(listener);
+                _exit(runJob(connection, job, run));
+            }
+            for (auto fd : job.fds)
+                close(fd);
+        }
+        close(connection);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include "protocol.h"
+#include <functional>
+#include <string>
+#include <vector>
+namespace server
+{
+using Arguments = std::vector<std::string>;
+
+// '-server=path', takes jobs on the unix socket until it is killed.
+// prepare runs in the server before the job forks, what it sets up (targets,
+// machines) stays for the jobs after it. run is the compile, in a process of its
+// own with the client's directory and streams, so no global state of one job
+// reaches the next and an exit() in the middle of it ends only that job
+int serve(const std::string &path, std::function<void(const Arguments &)> prepare,
+          std::function<int(const Arguments &)> run);
+} // namespace server
\ No newline at end of file
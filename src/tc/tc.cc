@@ -1,19 +1,43 @@
 #include "tc.h"
+#include "../ir/global.h"
 #include "../ir/ir.h"
 
 using namespace llvm;
 
-bool tc::targetGenerate(const std::string &filename)
+// one machine per set of options, shared by the optimizer and the code generator.
+// a single compile only ever needs one, the server keeps them across jobs.
+// a machine isn't safe to share between threads, each has its own
+static thread_local std::map<std::string, std::unique_ptr<TargetMachine>> TargetMachines;
+static thread_local TargetMachine *TheTargetMachine;
+static thread_local std::string TheTargetKey;
+
+void tc::initializeTargets()
 {
-    // Initialize the target registry etc.
-    InitializeAllTargetInfos();
-    InitializeAllTargets();
-    InitializeAllTargetMCs();
-    InitializeAllAsmParsers();
-    InitializeAllAsmPrinters();
+    static std::once_flag initialized;
+    std::call_once(initialized, [] {
+        // Initialize the target registry etc.
+        InitializeAllTargetInfos();
+        InitializeAllTargets();
+        InitializeAllTargetMCs();
+        InitializeAllAsmParsers();
+        InitializeAllAsmPrinters();
+    });
+}
 
+// everything of the options the machine is created from
+static std::string targetKey()
+{
+    std::stringstream key;
+    key << codegen_options.cpu << ";" << codegen_options.features << ";" << codegen_options.tune_cpu << ";"
+        << codegen_options.fast_math << codegen_options.no_signed_zeros << codegen_options.fp_contract << ";"
+        << codegen_options.opt_level << codegen_options.size_level;
+    return key.str();
+}
+
+// a machine from the options, '-march=native' already resolved
+static TargetMachine *newTargetMachine()
+{
     auto TargetTriple = sys::getDefaultTargetTriple();
-    module->setTargetTriple(TargetTriple);
 
     std::string Error;
     auto Target = TargetRegistry::lookupTarget(TargetTriple, Error);
@@ -24,45 +48,642 @@ bool tc::targetGenerate(const std::string &filename)
     if (!Target)
     {
         errs() << Error;
-        return 1;
+        return nullptr;
     }
 
-    auto CPU = "generic";
-    auto Features = "";
+    auto CPU = codegen_options.cpu;
+    auto Features = codegen_options.features;
 
     TargetOptions opt;
+    opt.UnsafeFPMath = codegen_options.fast_math;
+    opt.NoInfsFPMath = codegen_options.fast_math;
+    opt.NoNaNsFPMath = codegen_options.fast_math;
+    opt.NoSignedZerosFPMath = codegen_options.fast_math || codegen_options.no_signed_zeros;
+    opt.AllowFPOpFusion = codegen_options.fp_contract == ir::FPContractFast
+                              ? FPOpFusion::Fast
+                              : codegen_options.fp_contract == ir::FPContractOn ? FPOpFusion::Standard : FPOpFusion::Strict;
     auto RM = Optional<Reloc::Model>();
-    auto TheTargetMachine =
-        Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM);
+    // the backend works as hard as the ir optimizer, -Os/-Oz like -O2
+    auto opt_level = codegen_options.opt_level;
+    auto OL = codegen_options.size_level || opt_level == 2
+                  ? CodeGenOpt::Default
+                  : opt_level == 0 ? CodeGenOpt::None : opt_level == 1 ? CodeGenOpt::Less : CodeGenOpt::Aggressive;
+    return Target->createTargetMachine(TargetTriple, CPU, Features, opt, RM, None, OL);
+}
 
-    module->setDataLayout(TheTargetMachine->createDataLayout());
+TargetMachine *tc::getTargetMachine()
+{
+    if (TheTargetMachine && TheTargetKey == targetKey())
+        return TheTargetMachine;
+    tc::initializeTargets();
 
-    std::error_code EC;
-    raw_fd_ostream dest(filename, EC, sys::fs::F_None);
+    // '-march=native', the cpu and every feature of this machine
+    if (codegen_options.cpu == "native")
+    {
+        codegen_options.cpu = sys::getHostCPUName().str();
+        StringMap<bool> HostFeatures;
+        std::string Native;
+        if (sys::getHostCPUFeatures(HostFeatures))
+            for (auto &Feature : HostFeatures)
+                Native += (Feature.second ? ",+" : ",-") + Feature.first().str();
+        // explicit '-mattr' goes last and wins
+        if (!codegen_options.features.empty())
+            Native += "," + codegen_options.features;
+        if (!Native.empty())
+            codegen_options.features = Native.substr(1);
+    }
+    if (codegen_options.tune_cpu == "native")
+        codegen_options.tune_cpu = sys::getHostCPUName().str();
+    TheTargetKey = targetKey();
+    auto &Cached = TargetMachines[TheTargetKey];
+    if (!Cached)
+        Cached.reset(newTargetMachine());
+    return TheTargetMachine = Cached.get();
+}
 
-    if (EC)
+// triple, data layout and the per-function cpu, the optimizer and the backend must agree
+static void setModuleTarget(TargetMachine *Machine)
+{
+    module->setTargetTriple(Machine->getTargetTriple().str());
+    module->setDataLayout(Machine->createDataLayout());
+
+    auto cpu = Machine->getTargetCPU();
+    auto features = Machine->getTargetFeatureString();
+    auto size_level = codegen_options.size_level;
+    for (auto &function : *module)
     {
-        errs() << "Could not open file: " << EC.message();
+        if (function.isDeclaration())
+            continue;
+        // clones keep their own
+        if (function.hasFnAttribute("target-cpu"))
+            continue;
+        function.addFnAttr("target-cpu", cpu);
+        if (!features.empty())
+            function.addFnAttr("target-features", features);
+#if LLVM_VERSION_MAJOR >= 12
+        if (!codegen_options.tune_cpu.empty())
+            function.addFnAttr("tune-cpu", codegen_options.tune_cpu);
+#endif
+        // passes check the attributes to trade speed for size
+        if (size_level >= 1)
+            function.addFnAttr(Attribute::OptimizeForSize);
+        if (size_level >= 2)
+            function.addFnAttr(Attribute::MinSize);
+    }
+}
+
+// '-fmultiversion', from the least to the most capable, the resolver picks the last
+// one the cpu has. bit is the feature's index in '__cpu_model' of libgcc/compiler-rt
+static const struct
+{
+    const char *name;
+    unsigned bit;
+} CloneFeatures[] = {
+    {"popcnt", 2}, {"bmi", 16}, {"bmi2", 17}, {"sse4.1", 7}, {"sse4.2", 8},
+    {"avx", 9}, {"fma", 14}, {"avx2", 10}, {"avx512f", 15},
+};
+
+// one copy of every function per feature, picked at load time by an ifunc:
+// 'f' becomes the ifunc, 'f.default', 'f.avx2', ... the copies and 'f.resolver' tests cpuid
+static bool multiversion(TargetMachine *Machine)
+{
+    auto &versions = codegen_options.multiversion;
+    if (versions.empty())
+        return 0;
+    auto arch = Machine->getTargetTriple().getArch();
+    if (arch != Triple::x86 && arch != Triple::x86_64)
+    {
+        errs() << "-fmultiversion needs a x86 target\n";
         return 1;
     }
+    std::vector<std::pair<std::string, unsigned>> clone_features;
+    for (auto &feature : CloneFeatures)
+    {
+        if (std::find(versions.begin(), versions.end(), feature.name) != versions.end())
+            clone_features.emplace_back(feature.name, feature.bit);
+    }
+    for (auto &version : versions)
+    {
+        auto same = [&](const std::pair<std::string, unsigned> &feature) { return feature.first == version; };
+        if (std::find_if(clone_features.begin(), clone_features.end(), same) == clone_features.end())
+        {
+            errs() << "-fmultiversion: unknown feature '" << version << "'\n";
+            return 1;
+        }
+    }
+
+    auto &ctx = module->getContext();
+    auto int32_ty = Type::getInt32Ty(ctx);
+    auto cpu_model_ty = StructType::get(ctx, {int32_ty, int32_ty, int32_ty, ArrayType::get(int32_ty, 1)});
+    auto cpu_model = module->getOrInsertGlobal("__cpu_model", cpu_model_ty);
+    auto cpu_init = module->getOrInsertFunction("__cpu_indicator_init", Type::getVoidTy(ctx));
+
+    std::vector<Function *> functions;
+    for (auto &function : *module)
+    {
+        if (!function.isDeclaration() && function.hasExternalLinkage() && function.getName() != "main")
+            functions.push_back(&function);
+    }
+    for (auto function : functions)
+    {
+        std::string name = function->getName().str();
+        auto base_features = function->getFnAttribute("target-features").getValueAsString().str();
+        std::vector<Function *> clones;
+        for (auto &feature : clone_features)
+        {
+            ValueToValueMapTy VMap;
+            auto clone = CloneFunction(function, VMap);
+            clone->setName(name + "." + feature.first);
+            clone->setLinkage(GlobalValue::InternalLinkage);
+            clone->addFnAttr("target-features", (base_features.empty() ? "" : base_features + ",") + "+" + feature.first);
+            clones.push_back(clone);
+        }
+        function->setName(name + ".default");
+        function->setLinkage(GlobalValue::InternalLinkage);
+
+        // every use, recursive calls in the copies too, goes through the ifunc
+        auto resolver = Function::Create(FunctionType::get(function->getType(), false),
+                                         GlobalValue::InternalLinkage, name + ".resolver", module.get());
+        auto ifunc = GlobalIFunc::create(function->getFunctionType(), function->getType()->getAddressSpace(),
+                                         GlobalValue::ExternalLinkage, name, resolver, module.get());
+        function->replaceAllUsesWith(ifunc);
+
+        IRBuilder<> resolver_builder(BasicBlock::Create(ctx, "entry", resolver));
+        resolver_builder.CreateCall(cpu_init);
+        // __cpu_model.__cpu_features[0]
+        auto bits_ptr = resolver_builder.CreateInBoundsGEP(
+            cpu_model_ty, cpu_model, {resolver_builder.getInt32(0), resolver_builder.getInt32(3), resolver_builder.getInt32(0)});
+        auto bits = resolver_builder.CreateLoad(int32_ty, bits_ptr);
+        Value *best = function;
+        for (unsigned i = 0; i < clones.size(); ++i)
+        {
+            auto mask = ConstantInt::get(int32_ty, 1u << clone_features[i].second);
+            auto has = resolver_builder.CreateICmpNE(resolver_builder.CreateAnd(bits, mask), ConstantInt::get(int32_ty, 0));
+            best = resolver_builder.CreateSelect(has, clones[i], best);
+        }
+        resolver_builder.CreateRet(best);
+    }
+    return 0;
+}
+
+// clang links instrumented programs with -u__llvm_profile_runtime, the reference
+// lets a plain 'cc prog.o libncc_profile.a' pull the runtime in
+static void referenceProfileRuntime()
+{
+    auto int32_ty = Type::getInt32Ty(module->getContext());
+    auto hook = module->getOrInsertGlobal("__llvm_profile_runtime", int32_ty);
+    auto user = Function::Create(FunctionType::get(int32_ty, false), GlobalValue::LinkOnceODRLinkage,
+                                 "__llvm_profile_runtime_user", module.get());
+    user->setVisibility(GlobalValue::HiddenVisibility);
+    user->addFnAttr(Attribute::NoInline);
+    IRBuilder<> user_builder(BasicBlock::Create(module->getContext(), "entry", user));
+    user_builder.CreateRet(user_builder.CreateLoad(int32_ty, hook));
+    appendToUsed(*module, {user});
+}
 
+// LLVM 13 moved the levels out of PassBuilder
+#if LLVM_VERSION_MAJOR >= 13
+using OptLevel = OptimizationLevel;
+#else
+using OptLevel = PassBuilder::OptimizationLevel;
+#endif
+
+// the pipelines clang runs for -O1..-O3/-Os/-Oz
+enum Pipeline
+{
+    PerModule, // a unit on its own
+    PreLink,   // a unit of '-flto', inlining and the rest wait for the link
+    ThinPreLink, // a unit of '-flto=thin', ready for its summary
+    LTO,       // the linked program
+};
+
+static bool runPipeline(TargetMachine *Machine, Pipeline pipeline)
+{
+    auto opt_level = codegen_options.opt_level;
+    auto size_level = codegen_options.size_level;
+    auto &profile_generate = codegen_options.profile_generate;
+    auto &profile_use = codegen_options.profile_use;
+    if (!opt_level && !size_level)
+    {
+        if (profile_generate.empty() && profile_use.empty())
+            return 0;
+        errs() << "-fprofile-generate and -fprofile-use need -O1 or above\n";
+        return 1;
+    }
+
+    // the pipeline instruments or reads the profile before inlining,
+    // the counts then guide the inliner, block placement and hot/cold sections
+    Optional<PGOOptions> PGO;
+    if (!profile_use.empty() && !sys::fs::exists(profile_use))
+    {
+        errs() << "profile '" << profile_use << "' not found\n";
+        return 1;
+    }
+    if (!profile_generate.empty() || !profile_use.empty())
+    {
+        bool generate = !profile_generate.empty();
+#if LLVM_VERSION_MAJOR >= 9
+        PGO = PGOOptions(generate ? profile_generate : profile_use, "", "",
+                         generate ? PGOOptions::IRInstr : PGOOptions::IRUse);
+#elif LLVM_VERSION_MAJOR == 8
+        PGO = PGOOptions(profile_generate, generate ? "" : profile_use, "", "", generate);
+#else
+        PGO = PGOOptions(profile_generate, generate ? "" : profile_use, "", generate);
+#endif
+    }
+#if LLVM_VERSION_MAJOR >= 9
+    PassBuilder PB(Machine, PipelineTuningOptions(), PGO);
+#else
+    PassBuilder PB(Machine, PGO);
+#endif
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    // the default alias analysis is empty, register the real one first
+    FAM.registerPass([&] { return PB.buildDefaultAAPipeline(); });
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    auto Level = size_level == 2
+                     ? OptLevel::Oz
+                     : size_level == 1
+                           ? OptLevel::Os
+                           : opt_level == 1 ? OptLevel::O1 : opt_level == 2 ? OptLevel::O2 : OptLevel::O3;
+    ModulePassManager MPM;
+    if (pipeline == PerModule)
+        MPM = PB.buildPerModuleDefaultPipeline(Level);
+    else if (pipeline == PreLink)
+        MPM = PB.buildLTOPreLinkDefaultPipeline(Level);
+    else if (pipeline == ThinPreLink)
+        MPM = PB.buildThinLTOPreLinkDefaultPipeline(Level);
+    else
+#if LLVM_VERSION_MAJOR >= 12
+        MPM = PB.buildLTODefaultPipeline(Level, nullptr);
+#elif LLVM_VERSION_MAJOR >= 7
+        MPM = PB.buildLTODefaultPipeline(Level, false, nullptr);
+#else
+        MPM = PB.buildLTODefaultPipeline(Level);
+#endif
+    MPM.run(*module, MAM);
+    // the linked program has the reference of its units already
+    if (!profile_generate.empty() && pipeline != LTO)
+        referenceProfileRuntime();
+    return 0;
+}
+
+bool tc::optimize()
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return 1;
+    setModuleTarget(Machine);
+    // before the pipeline, each copy is optimized for its features
+    if (multiversion(Machine))
+        return 1;
+    auto lto = codegen_options.lto;
+    return runPipeline(Machine, lto == ir::LTOThin ? ThinPreLink : lto == ir::LTOFull ? PreLink : PerModule);
+}
+
+// '-flto', the units as bitcode linked into a new module of this thread. they come
+// from contexts of their own, each Generate replaces the one before
+bool tc::linkUnits(const std::vector<std::pair<std::string, SmallString<0>>> &units)
+{
+    ir::CreateIrUnit();
+    for (auto &unit : units)
+    {
+        auto part = parseBitcodeFile(MemoryBufferRef(unit.second.str(), unit.first), *context);
+        if (!part)
+        {
+            errs() << unit.first << ": " << toString(part.takeError()) << "\n";
+            return 1;
+        }
+        // a symbol defined twice is reported by the linker
+        if (Linker::linkModules(*module, std::move(*part)))
+        {
+            errs() << "-flto: can't link " << unit.first << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// '-flto', only main, '-fexport' and what the profile runtime looks up stay visible
+// outside the program. the rest is internal, inlined across units and dropped unused
+static bool exported(StringRef name)
+{
+    auto &exports = codegen_options.exports;
+    return name == "main" || name.startswith("__llvm_profile") ||
+           std::find(exports.begin(), exports.end(), name.str()) != exports.end();
+}
+
+bool tc::optimizeLTO()
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return 1;
+    setModuleTarget(Machine);
+    internalizeModule(*module, [](const GlobalValue &value) { return exported(value.getName()); });
+    return runPipeline(Machine, LTO);
+}
+
+// one object for M, the machine has to be the thread's own
+static bool emitModule(Module &M, TargetMachine *Machine, raw_pwrite_stream &dest)
+{
     legacy::PassManager pass;
     auto FileType = TargetMachine::CGFT_ObjectFile;
 
 #if LLVM_VERSION_MAJOR == 6
-    if (TheTargetMachine->addPassesToEmitFile(pass, dest, FileType))
+    if (Machine->addPassesToEmitFile(pass, dest, FileType))
 #else
-    if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType))
+    if (Machine->addPassesToEmitFile(pass, dest, nullptr, FileType))
 #endif
     {
         errs() << "TheTargetMachine can't emit a file of this type";
         return 1;
     }
 
-    pass.run(*module);
+    pass.run(M);
+    return 0;
+}
+
+// '-fparallel-codegen=N', the module is split into N parts that still link (locals
+// used across parts become hidden globals). a context isn't shared between threads,
+// each part goes through bitcode into one of its own and is compiled on its own
+// thread and machine
+bool tc::emitObjects(std::vector<SmallString<0>> &objects)
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return 1;
+    setModuleTarget(Machine);
+    auto parts = std::max(codegen_options.parallel_codegen, 1u);
+
+    std::vector<SmallString<0>> bitcodes;
+    auto save = [&](std::unique_ptr<Module> part) {
+        bitcodes.emplace_back();
+        raw_svector_ostream stream(bitcodes.back());
+#if LLVM_VERSION_MAJOR >= 7
+        WriteBitcodeToFile(*part, stream);
+#else
+        WriteBitcodeToFile(part.get(), stream);
+#endif
+    };
+#if LLVM_VERSION_MAJOR >= 13
+    SplitModule(*module, parts, save);
+#elif LLVM_VERSION_MAJOR >= 7
+    SplitModule(CloneModule(*module), parts, save);
+#else
+    SplitModule(CloneModule(module.get()), parts, save);
+#endif
+
+    // the options are the thread's, the machines are made here
+    std::vector<std::unique_ptr<TargetMachine>> machines;
+    for (size_t i = 0; i < bitcodes.size(); ++i)
+    {
+        machines.emplace_back(newTargetMachine());
+        if (!machines.back())
+            return 1;
+    }
+    objects.clear();
+    objects.resize(bitcodes.size());
+    std::vector<char> failed(bitcodes.size(), 0);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < bitcodes.size(); ++i)
+    {
+        workers.emplace_back([&, i] {
+            LLVMContext part_context;
+            auto part = parseBitcodeFile(MemoryBufferRef(bitcodes[i].str(), "part"), part_context);
+            if (!part)
+            {
+                errs() << toString(part.takeError()) << "\n";
+                failed[i] = 1;
+                return;
+            }
+            raw_svector_ostream stream(objects[i]);
+            failed[i] = emitModule(**part, machines[i].get(), stream);
+        });
+    }
+    for (auto &worker : workers)
+        worker.join();
+    return std::find(failed.begin(), failed.end(), 1) != failed.end();
+}
+
+// the parts as 'x.0.o', 'x.1.o', ... or merged into 'x.o' by 'ld -r' ($LD)
+static bool writeObjects(std::vector<SmallString<0>> &objects, const std::string &filename)
+{
+    // a thin link leaves the task of the regular modules empty
+    objects.erase(std::remove_if(objects.begin(), objects.end(),
+                                 [](const SmallString<0> &object) { return object.empty(); }),
+                  objects.end());
+    auto stem = filename.substr(0, filename.find_last_of('.'));
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        SmallString<128> path;
+        int fd = -1;
+        std::error_code EC;
+        if (codegen_options.split_objects)
+            path = stem + "." + std::to_string(i) + ".o";
+        else
+            EC = sys::fs::createTemporaryFile("ncc-part", "o", fd, path);
+        std::unique_ptr<raw_fd_ostream> dest;
+        if (!EC)
+            dest.reset(fd < 0 ? new raw_fd_ostream(path, EC, sys::fs::F_None) : new raw_fd_ostream(fd, true));
+        if (EC)
+        {
+            errs() << "Could not open file: " << EC.message();
+            return 1;
+        }
+        *dest << objects[i];
+        paths.push_back(path.str().str());
+    }
+    if (codegen_options.split_objects)
+    {
+        for (auto &path : paths)
+            outs() << "Wrote " << path << "\n";
+        return 0;
+    }
+
+    auto linker_name = getenv("LD") ? getenv("LD") : "ld";
+    auto linker = sys::findProgramByName(linker_name);
+    int res = 1;
+    if (!linker)
+        errs() << "no '" << linker_name << "' to merge the parts, -fsplit-objects keeps them apart\n";
+    else
+    {
+#if LLVM_VERSION_MAJOR >= 7
+        std::vector<StringRef> args = {*linker, "-r", "-o", filename};
+        for (auto &path : paths)
+            args.push_back(path);
+        res = sys::ExecuteAndWait(*linker, args);
+#else
+        std::vector<const char *> args = {linker->c_str(), "-r", "-o", filename.c_str()};
+        for (auto &path : paths)
+            args.push_back(path.c_str());
+        args.push_back(nullptr);
+        res = sys::ExecuteAndWait(*linker, args.data());
+#endif
+        if (res)
+            errs() << "'" << *linker << " -r' failed merging the parts\n";
+    }
+    for (auto &path : paths)
+        sys::fs::remove(path);
+    if (!res)
+        outs() << "Wrote " << filename << "\n";
+    return res != 0;
+}
+
+bool tc::targetGenerate(const std::string &filename)
+{
+    if (codegen_options.parallel_codegen > 1)
+    {
+        std::vector<SmallString<0>> objects;
+        return tc::emitObjects(objects) || writeObjects(objects, filename);
+    }
+
+    std::error_code EC;
+    raw_fd_ostream dest(filename, EC, sys::fs::F_None);
+
+    if (EC)
+    {
+        errs() << "Could not open file: " << EC.message();
+        return 1;
+    }
+    if (tc::emitObject(dest))
+        return 1;
     dest.flush();
 
     outs() << "Wrote " << filename << "\n";
 
     return 0;
+}
+
+bool tc::emitObject(raw_pwrite_stream &dest)
+{
+    auto TheTargetMachine = tc::getTargetMachine();
+    if (!TheTargetMachine)
+        return 1;
+    setModuleTarget(TheTargetMachine);
+    return emitModule(*module, TheTargetMachine, dest);
+}
+
+// '-flto=thin', every unit keeps its module, the summaries are linked instead. each
+// backend imports what it inlines from the others, internalizes what isn't exported
+// and compiles its unit, '-flto-jobs' of them at a time. with '-flto-cache' a backend
+// whose unit, imports and options are unchanged reuses its object
+bool tc::thinLink(const std::vector<std::pair<std::string, SmallString<0>>> &units, const std::string &filename)
+{
+    auto Machine = tc::getTargetMachine();
+    if (!Machine)
+        return 1;
+
+    lto::Config config;
+    config.CPU = Machine->getTargetCPU().str();
+    SmallVector<StringRef, 8> features;
+    Machine->getTargetFeatureString().split(features, ',', -1, false);
+    for (auto &feature : features)
+        config.MAttrs.push_back(feature.str());
+    config.Options = Machine->Options;
+    config.RelocModel = Machine->getRelocationModel();
+    config.CGOptLevel = Machine->getOptLevel();
+    config.OptLevel = std::max(codegen_options.opt_level, codegen_options.size_level ? 2u : 0u);
+#if LLVM_VERSION_MAJOR >= 7 && LLVM_VERSION_MAJOR < 14
+    config.UseNewPM = true;
+#endif
+    auto jobs = codegen_options.lto_jobs ? codegen_options.lto_jobs : std::max(std::thread::hardware_concurrency(), 1u);
+    // a thread strategy from LLVM 11, a count before
+#if LLVM_VERSION_MAJOR >= 11
+    lto::LTO lto(std::move(config), lto::createInProcessThinBackend(heavyweight_hardware_concurrency(jobs)));
+#else
+    lto::LTO lto(std::move(config), lto::createInProcessThinBackend(jobs));
+#endif
+
+    // the first definition prevails, like in a link of the objects
+    std::set<std::string> defined;
+    for (auto &unit : units)
+    {
+        auto input = lto::InputFile::create(MemoryBufferRef(unit.second.str(), unit.first));
+        if (!input)
+        {
+            errs() << unit.first << ": " << toString(input.takeError()) << "\n";
+            return 1;
+        }
+        std::vector<lto::SymbolResolution> resolutions;
+        for (auto &symbol : (*input)->symbols())
+        {
+            lto::SymbolResolution resolution;
+            auto name = symbol.getName().str();
+            auto first = !symbol.isUndefined() && defined.insert(name).second;
+            if (!symbol.isUndefined() && !first && !symbol.isWeak())
+            {
+                errs() << "-flto=thin: '" << name << "' is defined again in " << unit.first << "\n";
+                return 1;
+            }
+            resolution.Prevailing = first;
+            resolution.VisibleToRegularObj = exported(name);
+            resolution.FinalDefinitionInLinkageUnit = resolution.Prevailing;
+            resolutions.push_back(resolution);
+        }
+        if (auto error = lto.add(std::move(*input), resolutions))
+        {
+            errs() << unit.first << ": " << toString(std::move(error)) << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<SmallString<0>> objects(lto.getMaxTasks());
+#if LLVM_VERSION_MAJOR >= 14
+    using ObjectStream = CachedFileStream;
+#else
+    using ObjectStream = lto::NativeObjectStream;
+#endif
+    // the callbacks take the module name from LLVM 16
+#if LLVM_VERSION_MAJOR >= 16
+    auto add_stream = [&](unsigned task, const Twine &) {
+#else
+    auto add_stream = [&](unsigned task) {
+#endif
+        return std::unique_ptr<ObjectStream>(
+            new ObjectStream(std::unique_ptr<raw_pwrite_stream>(new raw_svector_ostream(objects[task]))));
+    };
+#if LLVM_VERSION_MAJOR >= 16
+    auto add_buffer = [&](unsigned task, const Twine &, std::unique_ptr<MemoryBuffer> buffer) {
+#else
+    auto add_buffer = [&](unsigned task, std::unique_ptr<MemoryBuffer> buffer) {
+#endif
+        objects[task] = buffer->getBuffer();
+    };
+    auto &cache_dir = codegen_options.lto_cache;
+#if LLVM_VERSION_MAJOR >= 14
+    FileCache cache;
+#else
+    lto::NativeObjectCache cache;
+#endif
+    if (!cache_dir.empty())
+    {
+#if LLVM_VERSION_MAJOR >= 14
+        auto local = localCache("ThinLTO", "Thin", cache_dir, add_buffer);
+#else
+        auto local = lto::localCache(cache_dir, add_buffer);
+#endif
+        if (!local)
+        {
+            errs() << "-flto-cache: " << toString(local.takeError()) << "\n";
+            return 1;
+        }
+        cache = std::move(*local);
+    }
+    if (auto error = lto.run(add_stream, cache))
+    {
+        errs() << "-flto=thin: " << toString(std::move(error)) << "\n";
+        return 1;
+    }
+    // old entries go, with the default policy
+    if (!cache_dir.empty())
+        pruneCache(cache_dir, CachePruningPolicy());
+    return writeObjects(objects, filename);
 }
\ No newline at end of file
@@ -5,9 +5,19 @@
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/LTO/LTO.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/CachePruning.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/Program.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_os_ostream.h>
@@ -15,14 +25,41 @@
 #include <llvm/Support/raw_sha1_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
+#if LLVM_VERSION_MAJOR >= 14
+#include <llvm/Support/Caching.h>
+#else
+#include <llvm/LTO/Caching.h>
+#endif
+#include <llvm/Transforms/IPO/Internalize.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 namespace tc
 {
-
+// registers every target once, the first machine does it if nobody did before
+void initializeTargets();
+// host machine, created on first use from the command line options
+llvm::TargetMachine *getTargetMachine();
+// run the '-O' pipeline on the module, nothing at -O0
+bool optimize();
+// '-flto', the units (name, bitcode) linked into one module, then optimized as a whole
+bool linkUnits(const std::vector<std::pair<std::string, llvm::SmallString<0>>> &units);
+bool optimizeLTO();
+// '-flto=thin', the units with their summaries through the thin link and the backends
+bool thinLink(const std::vector<std::pair<std::string, llvm::SmallString<0>>> &units, const std::string &filename);
 bool targetGenerate(const std::string &filename);
+// the object file of the module into dest, e.g. a raw_svector_ostream in memory
+bool emitObject(llvm::raw_pwrite_stream &dest);
+// '-fparallel-codegen=N', an object per part of the module, to be linked together
+bool emitObjects(std::vector<llvm::SmallString<0>> &objects);
 } // namespace tc
\ No newline at end of file
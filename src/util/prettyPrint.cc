@@ -4,7 +4,10 @@
 #include <sstream>
 #include "prettyPrint.h"
 
-extern std::string current_file;
+thread_local std::string pretty::file;
+thread_local const std::string *pretty::source = nullptr;
+thread_local std::ostream *pretty::err = &std::cerr;
+thread_local std::ostream *pretty::out = &std::cout;
 
 std::string pretty::setColor(const std::string &str, int color)
 {
@@ -23,53 +26,59 @@ void pretty::pretty_print(const std::string type, const std::string msg, std::pa
 {
     if (left.first > right.first || (left.first == right.first && left.second > right.second))
     {
-        std::cerr << "[print_error internal error] inivalid left and right arguments." << std::endl;
+        *err << "[print_error internal error] inivalid left and right arguments." << std::endl;
         return;
     }
 
-    std::ifstream fin(current_file);
-    if (!fin.is_open())
+    std::ifstream file_in;
+    std::istringstream source_in(source ? *source : "");
+    if (!source)
     {
-        std::cerr << "[print_error internal error] cannot open file " << current_file << "." << std::endl;
-        return;
+        file_in.open(file);
+        if (!file_in.is_open())
+        {
+            *err << "[print_error internal error] cannot open file " << file << "." << std::endl;
+            return;
+        }
     }
+    std::istream &fin = source ? (std::istream &)source_in : file_in;
     std::string line;
 
     int color;
-    std::cerr << current_file << ":" << left.first << ":" << left.second << ": ";
+    *err << file << ":" << left.first << ":" << left.second << ": ";
     if (type == "Warning")
     {
         color = YELLOW;
-        std::cerr << setColor("Warning: ", color);
+        *err << setColor("Warning: ", color);
     }
     else if (type == "Error")
     {
         color = RED;
-        std::cerr << setColor("Error: ", color);
+        *err << setColor("Error: ", color);
     }
     else
     {
         color = GREEN;
     }
 
-    std::cerr << setColor(msg, color) << std::endl;
+    *err << setColor(msg, color) << std::endl;
     if (left.first == right.first)
     {
         for (int i = 0; i < left.first; ++i)
         {
             getline(fin, line);
         }
-        std::cerr << line << std::endl;
+        *err << line << std::endl;
 
         for (int i = 0; i < left.second; ++i)
         {
-            std::cerr << " ";
+            *err << " ";
         }
         for (int i = left.second; i <= right.second; ++i)
         {
-            std::cerr << setColor("~", PURPLE);
+            *err << setColor("~", PURPLE);
         }
-        std::cerr << std::endl;
+        *err << std::endl;
     }
     else if (left.first < right.first)
     {
@@ -77,25 +86,25 @@ void pretty::pretty_print(const std::string type, const std::string msg, std::pa
         {
             getline(fin, line);
         }
-        std::cerr << line << std::endl;
+        *err << line << std::endl;
         for (int i = 0; i < left.second; ++i)
         {
-            std::cerr << " ";
+            *err << " ";
         }
         for (int i = left.second; i <= line.size(); ++i)
         {
-            std::cerr << setColor("~", PURPLE);
+            *err << setColor("~", PURPLE);
         }
-        std::cerr << std::endl;
+        *err << std::endl;
         for (int i = left.first; i < right.first; ++i)
         {
             getline(fin, line);
-            std::cerr << line << std::endl;
+            *err << line << std::endl;
             for (int i = 0; i < line.size(); ++i)
             {
-                std::cerr << setColor("~", PURPLE);
+                *err << setColor("~", PURPLE);
             }
-            std::cerr << std::endl;
+            *err << std::endl;
         }
     }
 }
\ No newline at end of file
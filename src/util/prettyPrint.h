@@ -13,6 +13,13 @@ const int PURPLE = 35;
 const int GREY = 36;
 const int WHITE = 37;
 
+// where the diagnostics of this thread's compile go: the file they name, its text
+// when it came from memory (nullptr reads the file), errors and progress notes
+extern thread_local std::string file;
+extern thread_local const std::string *source;
+extern thread_local std::ostream *err;
+extern thread_local std::ostream *out;
+
 std::string setColor(const std::string &str, int color);
 std::string setBackground(const std::string &str, int color);
 void pretty_print(const std::string type, const std::string msg, std::pair<int, int> left, std::pair<int, int> right);
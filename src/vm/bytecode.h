@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+namespace vm
+{
+// every instruction is 'op a, b, c' on 64 bit registers of the current frame,
+// 'a' is the destination. jumps take the target as 'b | c << 16'.
+#define VM_OPCODES(X)                                       \
+    X(Mov)     /* a = b */                                  \
+    X(LoadK)   /* a = constants[b] */                       \
+    X(Add)     /* a = b + c, wraps */                       \
+    X(Sub)                                                  \
+    X(Mul)                                                  \
+    X(Div)                                                  \
+    X(Mod)                                                  \
+    X(Shl)                                                  \
+    X(Shr)                                                  \
+    X(And)                                                  \
+    X(Or)                                                   \
+    X(Xor)                                                  \
+    X(Neg)     /* a = -b */                                 \
+    X(Not)     /* a = !b */                                 \
+    X(BitNot)  /* a = ~b */                                 \
+    X(Bool)    /* a = b != 0 */                             \
+    X(Lt)                                                   \
+    X(Le)                                                   \
+    X(Gt)                                                   \
+    X(Ge)                                                   \
+    X(Eq)                                                   \
+    X(Ne)                                                   \
+    X(Sext8)   /* a = (int8_t)a, after a store to a char */ \
+    X(Zext8)                                                \
+    X(Sext16)                                               \
+    X(Zext16)                                               \
+    X(Sext32)                                               \
+    X(Zext32)                                               \
+    X(Jmp)                                                  \
+    X(Jz)      /* if a == 0 jump */                         \
+    X(Jnz)                                                  \
+    X(Call)    /* a = functions[b](c, c + 1, ...) */        \
+    X(Builtin) /* a = builtins[b](c, c + 1, ...) */         \
+    X(Ret)     /* return a */                               \
+    X(RetVoid)
+
+enum Opcode : uint16_t
+{
+#define VM_ENUM(op) op,
+    VM_OPCODES(VM_ENUM)
+#undef VM_ENUM
+};
+// the few library functions a program may call without declaring them
+enum BuiltinId : uint16_t
+{
+    Putchar,
+    Getchar,
+};
+
+struct Instruction
+{
+    uint16_t op, a, b, c;
+};
+struct Function
+{
+    std::string name;
+    uint16_t params = 0;
+    uint16_t registers = 0; // parameters first, then locals and temporaries
+    bool defined = false;
+    std::vector<Instruction> code;
+};
+struct Program
+{
+    std::vector<Function> functions;
+    std::vector<int64_t> constants;
+    int main = -1;
+};
+} // namespace vm
@@ -0,0 +1,721 @@
+#include "compiler.h"
+#include "../ir/global.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+// [helpers]
+// library functions run by the interpreter itself, with their number of parameters
+static const std::map<std::string, std::pair<vm::BuiltinId, size_t>> builtins = {
+    {"putchar", {vm::Putchar, 1}}, {"getchar", {vm::Getchar, 0}}};
+
+static bool IsPointer(ast::Node *declarator)
+{
+    if (declarator->type == "pointer")
+        return true;
+    for (auto child : declarator->children)
+    {
+        if (child->type == "*" || child->type == "pointer")
+            return true;
+    }
+    return false;
+}
+static bool IsFunction(ast::Node *declarator)
+{
+    for (auto child : declarator->children)
+    {
+        if (child->type == "parameter_list" || child->type == "(")
+            return true;
+    }
+    return false;
+}
+// parameter_declaration nodes, none for 'f(void)'
+static std::vector<ast::Node *> Parameters(ast::Node *declarator)
+{
+    std::vector<ast::Node *> res;
+    auto list = declarator->getNameChild("parameter_list");
+    if (!list)
+        return res;
+    for (auto param : list->children)
+    {
+        auto specifiers = param->children[0];
+        bool is_void = param->children.size() == 1 && specifiers->children.size() == 1 &&
+                       specifiers->children[0]->value == "void";
+        if (!is_void)
+            res.push_back(param.get());
+    }
+    return res;
+}
+static int64_t CharValue(const std::string &literal)
+{
+    // 'c' or '\c'
+    if (literal.size() < 4 || literal[1] != '\\')
+        return literal[1];
+    switch (literal[2])
+    {
+    case 'n':
+        return '\n';
+    case 't':
+        return '\t';
+    case 'r':
+        return '\r';
+    case '0':
+        return '\0';
+    default:
+        return literal[2];
+    }
+}
+
+// [compiler]
+void vm::Compiler::Error(ast::Node *node, const std::string &info)
+{
+    if (this->quiet)
+        throw "";
+    Errors(node, info);
+}
+size_t vm::Compiler::Emit(uint16_t op, uint16_t a, uint16_t b, uint16_t c)
+{
+    auto &code = this->Current().code;
+    code.push_back({op, a, b, c});
+    return code.size() - 1;
+}
+void vm::Compiler::Patch(size_t jump, size_t target)
+{
+    auto &inst = this->Current().code[jump];
+    inst.b = target & 0xffff;
+    inst.c = target >> 16;
+}
+uint16_t vm::Compiler::NewRegister(ast::Node *node)
+{
+    auto &function = this->Current();
+    if (this->top >= UINT16_MAX)
+        this->Error(node, "[vm] \'" + function.name + "\' : too many registers.");
+    function.registers = std::max<unsigned>(function.registers, this->top + 1);
+    return this->top++;
+}
+uint16_t vm::Compiler::Target(ast::Node *node, int dest)
+{
+    return dest >= 0 ? dest : this->NewRegister(node);
+}
+uint16_t vm::Compiler::Into(uint16_t reg, int dest)
+{
+    if (dest < 0 || dest == reg)
+        return reg;
+    this->Emit(Mov, dest, reg);
+    return dest;
+}
+uint16_t vm::Compiler::Release(unsigned mark, uint16_t reg)
+{
+    this->top = std::max(mark, reg + 1u);
+    return reg;
+}
+uint16_t vm::Compiler::Constant(ast::Node *node, int64_t value, int dest)
+{
+    auto &constants = this->program->constants;
+    auto found = this->constant_table.find(value);
+    if (found == this->constant_table.end())
+    {
+        if (constants.size() > UINT16_MAX)
+            this->Error(node, "[vm] too many constants.");
+        found = this->constant_table.emplace(value, constants.size()).first;
+        constants.push_back(value);
+    }
+    auto reg = this->Target(node, dest);
+    this->Emit(LoadK, reg, found->second);
+    return reg;
+}
+uint16_t vm::Compiler::Expression(ast::Node *node, int dest)
+{
+    auto compile = this->compile_expression.find(node->type);
+    if (compile == this->compile_expression.end())
+        this->Error(node, "[vm\\" + node->type + "] not supported by the bytecode backend, try \'-run\'.");
+    return compile->second(node, dest);
+}
+void vm::Compiler::Statement(ast::Node *node)
+{
+    if (node->type == "declaration")
+        return this->compile_statement.at("declaration")(node);
+    // temporaries die with the statement
+    auto mark = this->top;
+    auto compile = this->compile_statement.find(node->type);
+    if (compile != this->compile_statement.end())
+        compile->second(node);
+    else
+        this->Expression(node);
+    this->top = mark;
+}
+// a store to a narrower local wraps like the memory it would live in
+void vm::Compiler::Normalize(uint16_t reg, const Kind &kind)
+{
+    static const std::map<unsigned, std::pair<Opcode, Opcode>> extend = {
+        {8, {Sext8, Zext8}}, {16, {Sext16, Zext16}}, {32, {Sext32, Zext32}}};
+    if (kind.bits == 1)
+    {
+        this->Emit(Bool, reg, reg);
+        return;
+    }
+    auto op = extend.find(kind.bits);
+    if (op != extend.end())
+        this->Emit(kind.is_sign ? op->second.first : op->second.second, reg);
+}
+vm::Compiler::Local &vm::Compiler::LocalOf(ast::Node *node)
+{
+    while ((node->type == "expression" || node->type == "primary_expression") && node->children.size() == 1)
+        node = node->children[0].get();
+    if (node->type != "identifier")
+        this->Error(node, "[vm] only scalar locals can be assigned by the bytecode backend.");
+    for (auto scope = this->scopes.rbegin(); scope != this->scopes.rend(); ++scope)
+    {
+        auto local = scope->find(node->value);
+        if (local == scope->end())
+            continue;
+        if (local->second.opaque)
+            this->Error(node, "[vm] \'" + node->value + "\' : pointers are not supported by the bytecode backend.");
+        return local->second;
+    }
+    this->Error(node, "[vm] \'" + node->value + "\' : cannot find such identifier.");
+    throw "";
+}
+vm::Compiler::Kind vm::Compiler::ParseKind(ast::Node *node)
+{
+    static const std::map<std::string, unsigned> bits = {
+        {"void", 0}, {"bool", 1}, {"char", 8}, {"short", 16}, {"int", 32}, {"long", 64}};
+    Kind kind = {32, true, false};
+    for (auto child : node->children)
+    {
+        auto &value = child->value;
+        if (child->type == "type_qualifier" ||
+            (child->type == "storage_class_specifier" && (value == "auto" || value == "register")))
+            continue;
+        if (child->type != "type_specifier")
+            this->Error(child.get(), "[vm] \'" + value + "\' : only integer types are supported by the bytecode backend.");
+        if (value == "unsigned")
+            kind.is_sign = false;
+        else if (bits.count(value))
+            kind.bits = bits.at(value);
+        else if (value != "signed")
+            this->Error(child.get(), "[vm] \'" + value + "\' : only integer types are supported by the bytecode backend.");
+    }
+    kind.is_void = kind.bits == 0;
+    if (kind.bits == 1)
+        kind.is_sign = false;
+    // unsigned operations wrap below 64 bits in ir but not on the registers
+    if (this->quiet && !kind.is_sign && kind.bits > 1)
+        this->Error(node, "");
+    // char and short are promoted to int and stored zero extended, exact; from
+    // 'unsigned int' on the signed 64 bit registers would compare, divide and
+    // shift differently from '-run'
+    if (!kind.is_sign && kind.bits >= 32)
+        this->Error(node, "[vm] \'unsigned\' : unsigned int and long are not supported by the bytecode backend, try \'-run\'.");
+    return kind;
+}
+unsigned vm::Compiler::FunctionIndex(const std::string &name, ast::Node *node, int params)
+{
+    auto &functions = this->program->functions;
+    auto found = this->function_table.find(name);
+    if (found != this->function_table.end())
+    {
+        if (params >= 0 && functions[found->second].params != params)
+            this->Error(node, "[vm] \'" + name + "\' : conflicting number of parameters.");
+        return found->second;
+    }
+    if (params < 0)
+        this->Error(node, "[vm] \'" + name + "\' : implicit declaration of function.");
+    Function function;
+    function.name = name;
+    function.params = params;
+    functions.push_back(function);
+    return this->function_table[name] = functions.size() - 1;
+}
+bool vm::Compiler::DeclareFunction(ast::Node *declarator)
+{
+    if (!IsFunction(declarator))
+        return false;
+    auto name = declarator->getNameChild("identifier")->value;
+    this->FunctionIndex(name, declarator, Parameters(declarator).size());
+    return true;
+}
+// bottom-tested: jump to the test once, then 'body, step, test' per iteration.
+// 'continue' goes to the step, 'break' past the test.
+void vm::Compiler::CompileLoop(ast::Node *cond, ast::Node *step, ast::Node *body, bool test_first)
+{
+    auto entry = test_first ? this->Emit(Jmp) : 0;
+    auto start = this->Current().code.size();
+    this->loops.emplace_back();
+    this->Statement(body);
+    auto latch = this->Current().code.size();
+    if (step)
+        this->Statement(step);
+    if (test_first)
+        this->Patch(entry, this->Current().code.size());
+    if (cond)
+    {
+        auto mark = this->top;
+        this->Patch(this->Emit(Jnz, this->Expression(cond)), start);
+        this->top = mark;
+    }
+    else
+        this->Patch(this->Emit(Jmp), start);
+    auto loop = this->loops.back();
+    this->loops.pop_back();
+    for (auto jump : loop.breaks)
+        this->Patch(jump, this->Current().code.size());
+    for (auto jump : loop.continues)
+        this->Patch(jump, latch);
+}
+
+void vm::Compiler::Init()
+{
+    auto &compile_statement = this->compile_statement;
+    auto &compile_expression = this->compile_expression;
+
+    // [statements]
+    compile_statement["translation_unit"] = [&](ast::Node *node) {
+        for (auto child : node->children)
+            compile_statement.at(child->type)(child.get());
+    };
+    compile_statement["function_definition"] = [&](ast::Node *node) {
+        // node: [declaration_specifiers, declarator, compound_statement]
+        auto declarator = node->children[1].get();
+        auto name = declarator->getNameChild("identifier")->value;
+        auto return_kind = this->ParseKind(node->children[0].get());
+        if (IsPointer(declarator))
+            this->Error(declarator, "[vm\\function_definition] \'" + name + "\' : pointer return types are not supported.");
+        auto params = Parameters(declarator);
+        auto index = this->FunctionIndex(name, node, params.size());
+        if (this->program->functions[index].defined)
+            this->Error(node, "[vm\\function_definition] \'" + name + "\' : redefinition of function.");
+        this->program->functions[index].defined = true;
+        this->current = index;
+        this->top = 0;
+        this->return_kind = return_kind;
+        this->scopes.assign(1, {});
+        this->loops.clear();
+
+        // arguments arrive in the first registers
+        for (auto param : params)
+        {
+            auto kind = this->ParseKind(param->children[0].get());
+            auto param_declarator = param->children.size() > 1 ? param->children[1].get() : nullptr;
+            bool opaque = param_declarator && (IsPointer(param_declarator) || param_declarator->getNameChild("array"));
+            if (kind.is_void && !opaque)
+                this->Error(param, "[vm\\function_definition] \'" + name + "\' : parameter of type void.");
+            auto reg = this->NewRegister(param);
+            if (!opaque)
+                this->Normalize(reg, kind);
+            auto id = param_declarator ? param_declarator->getNameChild("identifier") : nullptr;
+            if (id)
+                this->scopes.back()[id->value] = {reg, kind, opaque};
+        }
+        this->Statement(node->children[2].get());
+        this->Emit(RetVoid);
+        this->scopes.clear();
+        if (name == "main")
+            this->program->main = index;
+    };
+    compile_statement["declaration"] = [&](ast::Node *node) {
+        // node: [declaration_specifiers, (init_declarator_list)]
+        auto kind = this->ParseKind(node->children[0].get());
+        if (node->children.size() < 2)
+            return;
+        for (auto child : node->children[1]->children)
+        {
+            auto declarator = child->type == "init_declarator" ? child->children[0].get() : child.get();
+            if (this->DeclareFunction(declarator))
+                continue;
+            auto name = declarator->getNameChild("identifier")->value;
+            if (this->scopes.empty())
+                this->Error(declarator, "[vm\\declaration] \'" + name + "\' : global variables are not supported by the bytecode backend.");
+            if (IsPointer(declarator) || declarator->getNameChild("array"))
+                this->Error(declarator, "[vm\\declaration] \'" + name + "\' : pointers and arrays are not supported by the bytecode backend.");
+            if (kind.is_void)
+                this->Error(declarator, "[vm\\declaration] \'" + name + "\' : variable of type void.");
+            Local local = {this->NewRegister(declarator), kind, false};
+            if (child->type == "init_declarator")
+            {
+                auto init = child->children[1].get();
+                if (init->type != "expression")
+                    this->Error(init, "[vm\\declaration] \'" + name + "\' : initializer lists are not supported by the bytecode backend.");
+                auto mark = this->top;
+                this->Expression(init, local.reg);
+                this->Normalize(local.reg, kind);
+                this->top = mark;
+            }
+            this->scopes.back()[name] = local;
+        }
+    };
+    compile_statement["compound_statement"] = [&](ast::Node *node) {
+        // node: [(declaration_list), (statement_list)]
+        this->scopes.emplace_back();
+        auto mark = this->top;
+        for (auto list : node->children)
+        {
+            for (auto child : list->children)
+                this->Statement(child.get());
+        }
+        this->top = mark;
+        this->scopes.pop_back();
+    };
+    compile_statement["expression_statement"] = [&](ast::Node *node) {};
+    compile_statement["if_statement"] = [&](ast::Node *node) {
+        auto mark = this->top;
+        auto skip = this->Emit(Jz, this->Expression(node->children[0].get()));
+        this->top = mark;
+        this->Statement(node->children[1].get());
+        this->Patch(skip, this->Current().code.size());
+    };
+    compile_statement["if_else_statement"] = [&](ast::Node *node) {
+        auto mark = this->top;
+        auto skip = this->Emit(Jz, this->Expression(node->children[0].get()));
+        this->top = mark;
+        this->Statement(node->children[1].get());
+        auto end = this->Emit(Jmp);
+        this->Patch(skip, this->Current().code.size());
+        this->Statement(node->children[2].get());
+        this->Patch(end, this->Current().code.size());
+    };
+    compile_statement["while_statement"] = [&](ast::Node *node) {
+        this->CompileLoop(node->children[0].get(), nullptr, node->children[1].get(), true);
+    };
+    compile_statement["do_statement"] = [&](ast::Node *node) {
+        this->CompileLoop(node->children[1].get(), nullptr, node->children[0].get(), false);
+    };
+    compile_statement["for_statement"] = [&](ast::Node *node) {
+        // node: [init, cond, (step), body], init and cond may be an empty expression_statement
+        auto &children = node->children;
+        auto cond = children[1]->type != "expression_statement" ? children[1].get() : nullptr;
+        auto step = children.size() == 4 ? children[2].get() : nullptr;
+        this->Statement(children[0].get());
+        this->CompileLoop(cond, step, children.back().get(), true);
+    };
+    compile_statement["break"] = [&](ast::Node *node) {
+        if (this->loops.empty())
+            this->Error(node, "[vm\\break] \'break\' statement not in loop statement.");
+        this->loops.back().breaks.push_back(this->Emit(Jmp));
+    };
+    compile_statement["continue"] = [&](ast::Node *node) {
+        if (this->loops.empty())
+            this->Error(node, "[vm\\continue] \'continue\' statement not in loop statement.");
+        this->loops.back().continues.push_back(this->Emit(Jmp));
+    };
+    compile_statement["return_expr"] = [&](ast::Node *node) {
+        auto value = this->Expression(node->children[0].get());
+        if (!this->return_kind.is_void && this->return_kind.bits < 64)
+        {
+            auto reg = this->NewRegister(node);
+            this->Emit(Mov, reg, value);
+            this->Normalize(reg, this->return_kind);
+            value = reg;
+        }
+        this->Emit(Ret, value);
+    };
+    compile_statement["return_only"] = [&](ast::Node *node) {
+        this->Emit(RetVoid);
+    };
+
+    // [expressions]
+    compile_expression["expression"] = [&](ast::Node *node, int dest) -> uint16_t {
+        return this->Expression(node->children[0].get(), dest);
+    };
+    compile_expression["primary_expression"] = compile_expression["expression"];
+    compile_expression["comma_expression"] = [&](ast::Node *node, int dest) -> uint16_t {
+        auto &children = node->children;
+        for (size_t i = 0; i + 1 < children.size(); ++i)
+            this->Statement(children[i].get());
+        return this->Expression(children.back().get(), dest);
+    };
+    compile_expression["int"] = [&](ast::Node *node, int dest) -> uint16_t {
+        return this->Constant(node, atoll(node->value.c_str()), dest);
+    };
+    compile_expression["char"] = [&](ast::Node *node, int dest) -> uint16_t {
+        return this->Constant(node, CharValue(node->value), dest);
+    };
+    compile_expression["identifier"] = [&](ast::Node *node, int dest) -> uint16_t {
+        return this->Into(this->LocalOf(node).reg, dest);
+    };
+
+    static const std::map<std::string, Opcode> binary = {
+        {"add_expression", Add},
+        {"sub_expression", Sub},
+        {"mul_expression", Mul},
+        {"div_expression", Div},
+        {"mod_expression", Mod},
+        {"left_shift_expression", Shl},
+        {"right_shift_expression", Shr},
+        {"and_expression", And},
+        {"inclusive_or_expression", Or},
+        {"exclusive_or_expression", Xor},
+        {"lt_expression", Lt},
+        {"le_expression", Le},
+        {"gt_expression", Gt},
+        {"ge_expression", Ge},
+        {"equality_expression", Eq},
+        {"not_equality_expression", Ne}};
+    for (auto &item : binary)
+    {
+        auto op = item.second;
+        compile_expression[item.first] = [this, op](ast::Node *node, int dest) -> uint16_t {
+            auto mark = this->top;
+            auto lhs = this->Expression(node->children[0].get());
+            auto rhs = this->Expression(node->children[1].get());
+            // the operands are read before the result is written, it may reuse them
+            this->top = mark;
+            auto reg = this->Target(node, dest);
+            this->Emit(op, reg, lhs, rhs);
+            return reg;
+        };
+    }
+    static const std::map<std::string, Opcode> compound_assign = {
+        {"add_assign_expr", Add},
+        {"sub_assign_expr", Sub},
+        {"mul_assign_expr", Mul},
+        {"div_assign_expr", Div},
+        {"mod_assign_expr", Mod},
+        {"left_shift_assign_expr", Shl},
+        {"right_shift_assign_expr", Shr},
+        {"and_assign_expr", And},
+        {"or_assign_expr", Or},
+        {"xor_assign_expr", Xor}};
+    for (auto &item : compound_assign)
+    {
+        auto op = item.second;
+        compile_expression[item.first] = [this, op](ast::Node *node, int dest) -> uint16_t {
+            auto local = this->LocalOf(node->children[0].get());
+            auto mark = this->top;
+            this->Emit(op, local.reg, local.reg, this->Expression(node->children[1].get()));
+            this->Normalize(local.reg, local.kind);
+            this->top = mark;
+            return this->Into(local.reg, dest);
+        };
+    }
+    compile_expression["assign_expr"] = [&](ast::Node *node, int dest) -> uint16_t {
+        auto local = this->LocalOf(node->children[0].get());
+        auto mark = this->top;
+        this->Expression(node->children[1].get(), local.reg);
+        this->Normalize(local.reg, local.kind);
+        this->top = mark;
+        return this->Into(local.reg, dest);
+    };
+    // 0 or 1, the right side only runs when the left doesn't decide
+    auto logical = [&](ast::Node *node, int dest, Opcode skip_if) -> uint16_t {
+        auto mark = this->top;
+        auto reg = this->NewRegister(node);
+        this->Emit(Bool, reg, this->Expression(node->children[0].get()));
+        auto skip = this->Emit(skip_if, reg);
+        this->Emit(Bool, reg, this->Expression(node->children[1].get()));
+        this->Patch(skip, this->Current().code.size());
+        return this->Into(this->Release(mark, reg), dest);
+    };
+    compile_expression["logical_and_expression"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return logical(node, dest, Jz);
+    };
+    compile_expression["logical_or_expression"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return logical(node, dest, Jnz);
+    };
+    compile_expression["conditional_expression"] = [&](ast::Node *node, int dest) -> uint16_t {
+        // node: [cond, true, false]
+        auto mark = this->top;
+        auto reg = this->Target(node, dest);
+        auto skip = this->Emit(Jz, this->Expression(node->children[0].get()));
+        this->Expression(node->children[1].get(), reg);
+        auto end = this->Emit(Jmp);
+        this->Patch(skip, this->Current().code.size());
+        this->Expression(node->children[2].get(), reg);
+        this->Patch(end, this->Current().code.size());
+        return this->Release(mark, reg);
+    };
+    compile_expression["unary_operator"] = [&](ast::Node *node, int dest) -> uint16_t {
+        // node: [op, operand]
+        static const std::map<std::string, Opcode> unary = {{"-", Neg}, {"!", Not}, {"~", BitNot}};
+        auto &op = node->children[0]->value;
+        auto operand = node->children[1].get();
+        if (op == "+")
+            return this->Expression(operand, dest);
+        if (!unary.count(op))
+            this->Error(node, "[vm\\unary_operator] \'" + op + "\' : pointers are not supported by the bytecode backend.");
+        auto mark = this->top;
+        auto value = this->Expression(operand);
+        this->top = mark;
+        auto reg = this->Target(node, dest);
+        this->Emit(unary.at(op), reg, value);
+        return reg;
+    };
+    auto pre_step = [&](ast::Node *node, int dest, Opcode op) -> uint16_t {
+        auto local = this->LocalOf(node->children[0].get());
+        auto mark = this->top;
+        this->Emit(op, local.reg, local.reg, this->Constant(node, 1, -1));
+        this->Normalize(local.reg, local.kind);
+        this->top = mark;
+        return this->Into(local.reg, dest);
+    };
+    auto post_step = [&](ast::Node *node, int dest, Opcode op) -> uint16_t {
+        auto local = this->LocalOf(node->children[0].get());
+        auto reg = this->Target(node, dest);
+        this->Emit(Mov, reg, local.reg);
+        auto mark = this->top;
+        this->Emit(op, local.reg, local.reg, this->Constant(node, 1, -1));
+        this->Normalize(local.reg, local.kind);
+        this->top = mark;
+        return reg;
+    };
+    compile_expression["pre_inc_operator"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return pre_step(node, dest, Add);
+    };
+    compile_expression["pre_dec_operator"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return pre_step(node, dest, Sub);
+    };
+    compile_expression["post_inc_expression"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return post_step(node, dest, Add);
+    };
+    compile_expression["post_dev_expression"] = [=](ast::Node *node, int dest) -> uint16_t {
+        return post_step(node, dest, Sub);
+    };
+    compile_expression["cast_expression"] = [&](ast::Node *node, int dest) -> uint16_t {
+        // node: [type_name, expression]
+        auto kind = this->ParseKind(node->children[0].get());
+        auto mark = this->top;
+        auto value = this->Expression(node->children[1].get());
+        this->top = mark;
+        auto reg = this->Target(node, dest);
+        if (reg != value)
+            this->Emit(Mov, reg, value);
+        if (!kind.is_void)
+            this->Normalize(reg, kind);
+        return reg;
+    };
+    compile_expression["function_call"] = [&](ast::Node *node, int dest) -> uint16_t {
+        // node: [identifier, argument_expression_list | argument_list]
+        auto callee = node->children[0].get();
+        if (callee->type != "identifier")
+            this->Error(node, "[vm\\function_call] function pointers are not supported by the bytecode backend.");
+        auto &name = callee->value;
+        auto &args = node->children[1]->children;
+
+        uint16_t op = Call;
+        unsigned index = 0;
+        size_t params = 0;
+        auto builtin = builtins.find(name);
+        if (!this->function_table.count(name) && builtin != builtins.end())
+        {
+            if (this->quiet)
+                this->Error(node, "");
+            op = Builtin;
+            index = builtin->second.first;
+            params = builtin->second.second;
+        }
+        else
+        {
+            index = this->FunctionIndex(name, node, -1);
+            params = this->program->functions[index].params;
+            this->first_call.emplace(index, node);
+        }
+        if (args.size() != params)
+            this->Error(node, "[vm\\function_call] \'" + name + "\' : wrong number of arguments.");
+
+        // arguments in consecutive registers, copied into the callee's frame
+        auto mark = this->top;
+        for (size_t i = 0; i < args.size(); ++i)
+            this->NewRegister(node);
+        for (size_t i = 0; i < args.size(); ++i)
+            this->Expression(args[i].get(), mark + i);
+        this->top = mark;
+        auto reg = this->Target(node, dest);
+        this->Emit(op, reg, index, mark);
+        return reg;
+    };
+}
+
+void vm::Compiler::Reset(Program &program)
+{
+    program = Program();
+    this->program = &program;
+    this->scopes.clear();
+    this->function_table.clear();
+    this->first_call.clear();
+    this->constant_table.clear();
+}
+void vm::Compiler::Link()
+{
+    auto &functions = this->program->functions;
+    for (auto &call : this->first_call)
+    {
+        auto &function = functions[call.first];
+        if (!function.defined && (this->quiet || !builtins.count(function.name)))
+            this->Error(call.second, "[vm\\function_call] \'" + function.name + "\' : declared but never defined.");
+    }
+    // 'int putchar(int);' without a body is the builtin
+    for (auto &function : functions)
+    {
+        for (auto &inst : function.code)
+        {
+            if (inst.op == Call && !functions[inst.b].defined)
+            {
+                inst.op = Builtin;
+                inst.b = builtins.at(functions[inst.b].name).first;
+            }
+        }
+    }
+}
+
+bool vm::Compiler::Compile(ast::Node *root, Program &program)
+{
+    this->quiet = false;
+    try
+    {
+        this->Reset(program);
+        if (root->type != "translation_unit")
+            this->Error(root, "Ast root has to be a translation_unit.");
+        this->compile_statement.at("translation_unit")(root);
+        this->Link();
+        return true;
+    }
+    catch (const char *error)
+    {
+        std::cout << "[VM-Errors] bytecode generation is paused due to previous error.\n"
+                  << error << "\n";
+        return false;
+    }
+}
+bool vm::Compiler::Compile(ast::Node *root, const std::string &entry, Program &program)
+{
+    this->quiet = true;
+    try
+    {
+        this->Reset(program);
+        std::map<std::string, ast::Node *> definitions;
+        for (auto child : root->children)
+        {
+            if (child->type != "function_definition")
+                continue;
+            auto declarator = child->children[1].get();
+            auto name = declarator->getNameChild("identifier")->value;
+            definitions[name] = child.get();
+            this->FunctionIndex(name, child.get(), Parameters(declarator).size());
+        }
+        // callees turn up as calls to functions without code yet
+        std::vector<std::string> pending = {entry};
+        while (!pending.empty())
+        {
+            auto name = pending.back();
+            pending.pop_back();
+            auto definition = definitions.find(name);
+            if (definition == definitions.end())
+                return false;
+            if (this->program->functions[this->function_table.at(name)].defined)
+                continue;
+            this->compile_statement.at("function_definition")(definition->second);
+            for (auto &call : this->first_call)
+            {
+                auto &callee = program.functions[call.first];
+                if (!callee.defined)
+                    pending.push_back(callee.name);
+            }
+        }
+        this->Link();
+        return true;
+    }
+    catch (const char *)
+    {
+        return false;
+    }
+}
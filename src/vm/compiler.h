@@ -0,0 +1,80 @@
+#pragma once
+#include "../ast/ast.h"
+#include "bytecode.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+namespace vm
+{
+// lowers a translation unit to bytecode, the integer subset of c:
+// functions, scalar integer locals, arithmetic, control flow and calls.
+// anything else (pointers, arrays, globals, floats, switch) is an error.
+class Compiler
+{
+private:
+    // an integer local lives in one register for its whole scope
+    struct Kind
+    {
+        unsigned bits;
+        bool is_sign;
+        bool is_void;
+    };
+    struct Local
+    {
+        uint16_t reg;
+        Kind kind;
+        bool opaque; // a pointer parameter, passed in but never usable
+    };
+    // jumps to patch once the loop is done
+    struct Loop
+    {
+        std::vector<size_t> breaks;
+        std::vector<size_t> continues;
+    };
+    std::map<std::string, std::function<void(ast::Node *)>> compile_statement;
+    std::map<std::string, std::function<uint16_t(ast::Node *, int)>> compile_expression;
+    Program *program = nullptr;
+    bool quiet = false; // compile-time evaluation, a failure just means no constant
+    unsigned current = 0; // index of the function being compiled
+    unsigned top = 0;     // first free register
+    Kind return_kind;
+    std::vector<std::map<std::string, Local>> scopes;
+    std::vector<Loop> loops;
+    std::map<std::string, unsigned> function_table;
+    std::map<unsigned, ast::Node *> first_call; // to report calls to undefined functions
+    std::map<int64_t, uint16_t> constant_table;
+
+    Function &Current() { return this->program->functions[this->current]; }
+    void Error(ast::Node *node, const std::string &info);
+    void Reset(Program &program);
+    // every call has a callee, library functions become builtins
+    void Link();
+    size_t Emit(uint16_t op, uint16_t a = 0, uint16_t b = 0, uint16_t c = 0);
+    void Patch(size_t jump, size_t target);
+    uint16_t NewRegister(ast::Node *node);
+    // dest < 0 lets the expression pick, otherwise the value ends up in dest
+    uint16_t Target(ast::Node *node, int dest);
+    uint16_t Into(uint16_t reg, int dest);
+    // frees the temporaries above mark except reg
+    uint16_t Release(unsigned mark, uint16_t reg);
+    uint16_t Constant(ast::Node *node, int64_t value, int dest);
+    uint16_t Expression(ast::Node *node, int dest = -1);
+    void Statement(ast::Node *node);
+    void Normalize(uint16_t reg, const Kind &kind);
+    Local &LocalOf(ast::Node *node);
+    Kind ParseKind(ast::Node *node);
+    // params < 0 for a call, which needs an earlier declaration
+    unsigned FunctionIndex(const std::string &name, ast::Node *node, int params);
+    // a prototype, false if declarator isn't a function
+    bool DeclareFunction(ast::Node *declarator);
+    void CompileLoop(ast::Node *cond, ast::Node *step, ast::Node *body, bool test_first);
+
+public:
+    void Init();
+    bool Compile(ast::Node *root, Program &program);
+    // only entry and what it calls, for evaluation, nothing is reported
+    bool Compile(ast::Node *root, const std::string &entry, Program &program);
+    Compiler() { this->Init(); };
+};
+} // namespace vm
\ No newline at end of file
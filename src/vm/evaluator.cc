@@ -0,0 +1,49 @@
+#include "evaluator.h"
+#include "vm.h"
+
+void vm::Evaluator::Reset(ast::Node *translation_unit)
+{
+    this->unit = translation_unit;
+    this->programs.clear();
+    this->results.clear();
+}
+bool vm::Evaluator::Call(const std::string &name, const std::vector<int64_t> &args, int64_t &res)
+{
+    if (!this->unit)
+        return false;
+    auto key = std::make_pair(name, args);
+    auto result = this->results.find(key);
+    if (result != this->results.end())
+    {
+        res = result->second.second;
+        return result->second.first;
+    }
+
+    // the function and its callees, compiled once
+    auto program = this->programs.find(name);
+    if (program == this->programs.end())
+    {
+        std::unique_ptr<Program> compiled(new Program());
+        if (!this->compiler.Compile(this->unit, name, *compiled))
+            compiled.reset();
+        program = this->programs.emplace(name, std::move(compiled)).first;
+    }
+    auto &cached = this->results[key] = {false, 0};
+    if (!program->second)
+        return false;
+    auto &functions = program->second->functions;
+    for (unsigned i = 0; i < functions.size(); ++i)
+    {
+        if (functions[i].name != name)
+            continue;
+        if (functions[i].params != args.size())
+            return false;
+        auto run = vm::execute(*program->second, i, args, this->registers, this->steps);
+        if (run.status != Finished)
+            return false;
+        res = run.value;
+        cached = {true, res};
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "../ast/ast.h"
+#include "bytecode.h"
+#include "compiler.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+namespace vm
+{
+// calls of pure functions on constant arguments, run while compiling.
+// a function is pure when the bytecode backend takes it and all it calls,
+// integers in registers only: no memory, no globals, no library calls.
+class Evaluator
+{
+private:
+    ast::Node *unit = nullptr;
+    Compiler compiler;
+    std::map<std::string, std::unique_ptr<Program>> programs; // nullptr if not pure
+    std::map<std::pair<std::string, std::vector<int64_t>>, std::pair<bool, int64_t>> results;
+
+public:
+    uint64_t steps = 1 << 20;   // calls and loop iterations of one evaluation, '-fconstexpr-steps'
+    size_t registers = 1 << 16; // its stack
+
+    void Reset(ast::Node *translation_unit);
+    // false if name isn't pure or doesn't finish within the budgets
+    bool Call(const std::string &name, const std::vector<int64_t> &args, int64_t &res);
+};
+} // namespace vm
\ No newline at end of file
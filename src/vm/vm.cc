@@ -0,0 +1,330 @@
+#include "vm.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+// labels as values when the compiler has them, one indirect jump per instruction
+// instead of going back to a single switch
+#if defined(__GNUC__) || defined(__clang__)
+#define VM_COMPUTED_GOTO
+#endif
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_SWITCH() VM_DISPATCH();
+#define VM_DISPATCH()                 \
+    do                                \
+    {                                 \
+        inst = pc++;                  \
+        goto *labels[inst->op];       \
+    } while (0)
+#define VM_CASE(op) L_##op:
+#else
+#define VM_SWITCH() \
+    dispatch:       \
+    inst = pc++;    \
+    switch (inst->op)
+#define VM_DISPATCH() goto dispatch
+#define VM_CASE(op) case op:
+#endif
+
+#define R(x) base[inst->x]
+#define TARGET() (code + (inst->b | (uint32_t)inst->c << 16))
+// backward jumps use up a step, so every loop iteration does
+#define VM_JUMP()                    \
+    do                               \
+    {                                \
+        auto target = TARGET();      \
+        if (target < pc && !--steps) \
+            goto out_of_steps;       \
+        pc = target;                 \
+    } while (0)
+
+namespace
+{
+struct Frame
+{
+    const vm::Function *function;
+    const vm::Instruction *pc;
+    int64_t *base;
+    uint16_t result; // register of the caller receiving the return value
+};
+} // namespace
+
+vm::Result vm::execute(const Program &program, unsigned entry, const std::vector<int64_t> &args,
+                       size_t registers, uint64_t steps)
+{
+#ifdef VM_COMPUTED_GOTO
+    static const void *labels[] = {
+#define VM_LABEL(op) &&L_##op,
+        VM_OPCODES(VM_LABEL)
+#undef VM_LABEL
+    };
+#endif
+    std::vector<int64_t> stack(registers);
+    std::vector<Frame> frames;
+    const int64_t *constants = program.constants.data();
+    int64_t *stack_end = stack.data() + stack.size();
+
+    const Function *function = &program.functions[entry];
+    const Instruction *code = function->code.data();
+    const Instruction *pc = code;
+    const Instruction *inst = nullptr;
+    int64_t *base = stack.data();
+    if (function->registers > registers)
+        return {StackOverflow, 0, function};
+    std::copy(args.begin(), args.begin() + std::min<size_t>(args.size(), function->params), base);
+
+    VM_SWITCH()
+    {
+        VM_CASE(Mov)
+        {
+            R(a) = R(b);
+            VM_DISPATCH();
+        }
+        VM_CASE(LoadK)
+        {
+            R(a) = constants[inst->b];
+            VM_DISPATCH();
+        }
+        // wrap instead of the undefined signed overflow of the host
+        VM_CASE(Add)
+        {
+            R(a) = (int64_t)((uint64_t)R(b) + (uint64_t)R(c));
+            VM_DISPATCH();
+        }
+        VM_CASE(Sub)
+        {
+            R(a) = (int64_t)((uint64_t)R(b) - (uint64_t)R(c));
+            VM_DISPATCH();
+        }
+        VM_CASE(Mul)
+        {
+            R(a) = (int64_t)((uint64_t)R(b) * (uint64_t)R(c));
+            VM_DISPATCH();
+        }
+        VM_CASE(Div)
+        {
+            if (!R(c))
+                goto division_by_zero;
+            R(a) = R(c) == -1 ? (int64_t)(0 - (uint64_t)R(b)) : R(b) / R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Mod)
+        {
+            if (!R(c))
+                goto division_by_zero;
+            R(a) = R(c) == -1 ? 0 : R(b) % R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Shl)
+        {
+            R(a) = (int64_t)((uint64_t)R(b) << (R(c) & 63));
+            VM_DISPATCH();
+        }
+        VM_CASE(Shr)
+        {
+            R(a) = R(b) >> (R(c) & 63);
+            VM_DISPATCH();
+        }
+        VM_CASE(And)
+        {
+            R(a) = R(b) & R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Or)
+        {
+            R(a) = R(b) | R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Xor)
+        {
+            R(a) = R(b) ^ R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Neg)
+        {
+            R(a) = (int64_t)(0 - (uint64_t)R(b));
+            VM_DISPATCH();
+        }
+        VM_CASE(Not)
+        {
+            R(a) = !R(b);
+            VM_DISPATCH();
+        }
+        VM_CASE(BitNot)
+        {
+            R(a) = ~R(b);
+            VM_DISPATCH();
+        }
+        VM_CASE(Bool)
+        {
+            R(a) = R(b) != 0;
+            VM_DISPATCH();
+        }
+        VM_CASE(Lt)
+        {
+            R(a) = R(b) < R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Le)
+        {
+            R(a) = R(b) <= R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Gt)
+        {
+            R(a) = R(b) > R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Ge)
+        {
+            R(a) = R(b) >= R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Eq)
+        {
+            R(a) = R(b) == R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Ne)
+        {
+            R(a) = R(b) != R(c);
+            VM_DISPATCH();
+        }
+        VM_CASE(Sext8)
+        {
+            R(a) = (int8_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Zext8)
+        {
+            R(a) = (uint8_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Sext16)
+        {
+            R(a) = (int16_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Zext16)
+        {
+            R(a) = (uint16_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Sext32)
+        {
+            R(a) = (int32_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Zext32)
+        {
+            R(a) = (uint32_t)R(a);
+            VM_DISPATCH();
+        }
+        VM_CASE(Jmp)
+        {
+            VM_JUMP();
+            VM_DISPATCH();
+        }
+        VM_CASE(Jz)
+        {
+            if (!R(a))
+                VM_JUMP();
+            VM_DISPATCH();
+        }
+        VM_CASE(Jnz)
+        {
+            if (R(a))
+                VM_JUMP();
+            VM_DISPATCH();
+        }
+        VM_CASE(Call)
+        {
+            auto callee = &program.functions[inst->b];
+            // the callee's frame starts right after the caller's registers
+            auto callee_base = base + function->registers;
+            if (callee_base + callee->registers > stack_end)
+                return {StackOverflow, 0, callee};
+            if (!--steps)
+                goto out_of_steps;
+            std::copy(&R(c), &R(c) + callee->params, callee_base);
+            frames.push_back({function, pc, base, inst->a});
+            function = callee;
+            code = function->code.data();
+            pc = code;
+            base = callee_base;
+            VM_DISPATCH();
+        }
+        VM_CASE(Builtin)
+        {
+            switch (inst->b)
+            {
+            case Putchar:
+                R(a) = putchar((int)R(c));
+                break;
+            case Getchar:
+                R(a) = getchar();
+                break;
+            }
+            VM_DISPATCH();
+        }
+        VM_CASE(Ret)
+        {
+            auto value = R(a);
+            if (frames.empty())
+                return {Finished, value, function};
+            auto &frame = frames.back();
+            function = frame.function;
+            code = function->code.data();
+            pc = frame.pc;
+            base = frame.base;
+            base[frame.result] = value;
+            frames.pop_back();
+            VM_DISPATCH();
+        }
+        // falling off the end, 0 for main
+        VM_CASE(RetVoid)
+        {
+            if (frames.empty())
+                return {Finished, 0, function};
+            auto &frame = frames.back();
+            function = frame.function;
+            code = function->code.data();
+            pc = frame.pc;
+            base = frame.base;
+            base[frame.result] = 0;
+            frames.pop_back();
+            VM_DISPATCH();
+        }
+    }
+
+division_by_zero:
+    return {DivisionByZero, 0, function};
+out_of_steps:
+    return {OutOfSteps, 0, function};
+}
+
+int vm::run(const Program &program, const std::vector<std::string> &args)
+{
+    if (program.main < 0)
+    {
+        std::cerr << "[vm] no main function to run\n";
+        return 1;
+    }
+    // 'int main(int argc, char *argv[])', argv can't be dereferenced here
+    auto res = vm::execute(program, program.main, {(int64_t)args.size(), 0}, 1 << 20, UINT64_MAX);
+    switch (res.status)
+    {
+    case Finished:
+        return (int)res.value;
+    case DivisionByZero:
+        std::cerr << "[vm] division by zero in \'" << res.function->name << "\'\n";
+        return 1;
+    case StackOverflow:
+        std::cerr << "[vm] stack overflow in \'" << res.function->name << "\'\n";
+        return 1;
+    case OutOfSteps:
+        break;
+    }
+    return 1;
+}
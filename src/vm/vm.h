@@ -0,0 +1,27 @@
+#pragma once
+#include "bytecode.h"
+#include <string>
+#include <vector>
+namespace vm
+{
+enum Status
+{
+    Finished,
+    DivisionByZero,
+    StackOverflow,
+    OutOfSteps,
+};
+struct Result
+{
+    Status status;
+    int64_t value;            // the return value once finished
+    const Function *function; // where it stopped
+};
+// call functions[entry], the stack holds at most registers and calls plus
+// backward jumps together may take steps, nothing is printed
+Result execute(const Program &program, unsigned entry, const std::vector<int64_t> &args,
+               size_t registers, uint64_t steps);
+// '-vm', interpret main of a compiled program, nothing from llvm is used,
+// args[0] is the source file, the result is main's return value
+int run(const Program &program, const std::vector<std::string> &args);
+} // namespace vm
\ No newline at end of file
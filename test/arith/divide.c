@@ -0,0 +1,14 @@
+int main()
+{
+	int a = -7;
+	unsigned b = 7;
+	int q = a / 4 + a % 4;
+	unsigned r = b / 4 + b % 4;
+	int s = a / 3 + a % 3;
+	int i;
+	for (i = 0; i < 100; i = i + 1)
+	{
+		s = s + i * 2;
+	}
+	return q + r + s;
+}
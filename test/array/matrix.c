@@ -0,0 +1,20 @@
+int dot(int *a, int b[], int n)
+{
+	int s = 0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		s = s + a[i] * *(b + i);
+	}
+	return s;
+}
+
+int main()
+{
+	int m[2][3] = {{1, 2, 3}, {4, 5}};
+	int v[] = {1, 1, 1};
+	int *p = &m[1][0];
+	int *q = m[1] + 2;
+	m[0][2] = *p;
+	return dot(m[0], v, 3) + dot(p, v, q - p);
+}
@@ -0,0 +1,22 @@
+// a hot loop nest on locals, what mem2reg and the loop passes work on
+int factorial(int n)
+{
+	int res = 1;
+	int i;
+	for (i = 2; i <= n; i = i + 1)
+	{
+		res = res * i % 1000003;
+	}
+	return res;
+}
+int main()
+{
+	int ret = 0;
+	int round;
+	for (round = 0; round < 20000; round = round + 1)
+	{
+		ret = (ret + factorial(1000 + round % 7)) % 1000003;
+	}
+
+	return ret % 256;
+}
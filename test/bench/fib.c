@@ -0,0 +1,16 @@
+// recursive calls, what inlining and tail recursion elimination work on
+int fib(int n)
+{
+	if (n < 2)
+	{
+		return n;
+	}
+	return fib(n - 1) + fib(n - 2);
+}
+int main()
+{
+	int ret = 0;
+	ret = fib(32);
+
+	return ret % 256;
+}
@@ -0,0 +1,28 @@
+// a loop the vectorizer widens to the widest registers of the target cpu
+int saxpy(int n, float a, float *restrict x, float *restrict y)
+{
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		y[i] = a * x[i] + y[i];
+	}
+	return n;
+}
+int main()
+{
+	float x[4096];
+	float y[4096];
+	float a = 2;
+	int i;
+	for (i = 0; i < 4096; i = i + 1)
+	{
+		x[i] = i % 7;
+		y[i] = 0;
+	}
+	for (i = 0; i < 200000; i = i + 1)
+	{
+		saxpy(4096, a, x, y);
+	}
+
+	return y[7] > 0;
+}
@@ -0,0 +1,17 @@
+// both arms return, the merge block after the if/else is never reached
+int pick(int c, int a, int b)
+{
+	if (c)
+	{
+		return a;
+	}
+	else
+	{
+		return b;
+	}
+}
+
+int main()
+{
+	return pick(1, 4, 9) + pick(0, 4, 9);
+}
@@ -0,0 +1,22 @@
+int sign(long n)
+{
+	if (n < 0)
+	{
+		return 0 - 1;
+	}
+	else
+	{
+		if (n)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int main()
+{
+	int a = 3;
+	int b = a >= 2;
+	return sign(b);
+}
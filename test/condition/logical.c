@@ -0,0 +1,17 @@
+int check(int a, int b)
+{
+	if (a > 0 && b != 0 || a == 0)
+	{
+		return 1;
+	}
+	return 0;
+}
+
+int main()
+{
+	int a = 2;
+	int b = 3;
+	int max = a > b ? a : b;
+	int res = a ? check(a, b) : check(b, a);
+	return max + res;
+}
@@ -0,0 +1,27 @@
+// ncc -O1 -t=ir fold.c : 'fib(20)' is evaluated while compiling, no call is left in main,
+// 'table' has square(4) = 16 elements, exit code 124
+int fib(int n)
+{
+	int a = 0, b = 1, t;
+	while (n-- > 0)
+	{
+		t = a + b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+int square(int n)
+{
+	return n * n;
+}
+int main()
+{
+	int table[square(4)];
+	int i;
+	for (i = 0; i < 16; i = i + 1)
+	{
+		table[i] = i;
+	}
+	return fib(20) % 256 + table[15];
+}
@@ -0,0 +1,28 @@
+// ncc flags.c -t=ir                      : llvm.fmuladd in axpy, plain fadd in sum, flags.ll
+// ncc flags.c -t=ir -ffp-contract=off    : fmul + fadd, no llvm.fmuladd
+// ncc flags.c -t=ir -ffp-contract=fast   : 'contract' on every fp instruction
+// ncc flags.c -t=ir -ffast-math          : 'fast' on every fp instruction, "unsafe-fp-math" attribute
+// ncc flags.c -t=ir -fno-signed-zeros -freciprocal-math : 'nsz arcp'
+float axpy(float a, float x, float y)
+{
+	return a * x + y;
+}
+
+float sum(float *v, int n)
+{
+	float s = 0.0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		s = s + v[i];
+	}
+	return s / n;
+}
+
+int main()
+{
+	float v[4] = {1.0, 2.0, 3.0, 4.0};
+	float a = 2.0;
+	float y = 1.0;
+	return axpy(a, sum(v, 4), y);
+}
@@ -0,0 +1,122 @@
+; ModuleID = 'my JIT'
+source_filename = "my JIT"
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+
+define float @axpy(float %a, float %x, float %y) #0 {
+axpy_block:
+  %y3 = alloca float, align 4
+  %x2 = alloca float, align 4
+  %a1 = alloca float, align 4
+  store float %a, float* %a1, align 4
+  store float %x, float* %x2, align 4
+  store float %y, float* %y3, align 4
+  %0 = load float, float* %a1, align 4
+  %1 = load float, float* %x2, align 4
+  %2 = load float, float* %y3, align 4
+  %fmuladd = call float @llvm.fmuladd.f32(float %0, float %1, float %2)
+  ret float %fmuladd
+}
+
+; Function Attrs: nofree nosync nounwind readnone speculatable willreturn
+declare float @llvm.fmuladd.f32(float, float, float) #1
+
+define float @sum(float* %v, i32 %n) #0 {
+sum_block:
+  %i = alloca i32, align 4
+  %s = alloca float, align 4
+  %n2 = alloca i32, align 4
+  %v1 = alloca float*, align 8
+  store float* %v, float** %v1, align 8
+  store i32 %n, i32* %n2, align 4
+  %0 = bitcast float* %s to i8*
+  call void @llvm.lifetime.start.p0i8(i64 -1, i8* %0)
+  store float 0.000000e+00, float* %s, align 4
+  %1 = bitcast i32* %i to i8*
+  call void @llvm.lifetime.start.p0i8(i64 -1, i8* %1)
+  store i32 0, i32* %i, align 4
+  br label %loop_header
+
+loop_header:                                      ; preds = %loop_latch, %sum_block
+  %2 = load i32, i32* %i, align 4
+  %3 = load i32, i32* %n2, align 4
+  %cmp_tmp = icmp slt i32 %2, %3
+  br i1 %cmp_tmp, label %loop_body, label %loop_end
+
+loop_body:                                        ; preds = %loop_header
+  %4 = load i32, i32* %i, align 4
+  %idx_ext = sext i32 %4 to i64
+  %5 = load float*, float** %v1, align 8
+  %ptr_idx = getelementptr inbounds float, float* %5, i64 %idx_ext
+  %6 = load float, float* %s, align 4
+  %7 = load float, float* %ptr_idx, align 4
+  %8 = fadd float %6, %7
+  store float %8, float* %s, align 4
+  br label %loop_latch
+
+loop_latch:                                       ; preds = %loop_body
+  %9 = load i32, i32* %i, align 4
+  %10 = add nsw i32 %9, 1
+  store i32 %10, i32* %i, align 4
+  br label %loop_header, !llvm.loop !0
+
+loop_end:                                         ; preds = %loop_header
+  %11 = load float, float* %s, align 4
+  %12 = load i32, i32* %n2, align 4
+  %si2f_tmp = sitofp i32 %12 to float
+  %13 = fdiv float %11, %si2f_tmp
+  %14 = bitcast i32* %i to i8*
+  call void @llvm.lifetime.end.p0i8(i64 -1, i8* %14)
+  %15 = bitcast float* %s to i8*
+  call void @llvm.lifetime.end.p0i8(i64 -1, i8* %15)
+  ret float %13
+}
+
+; Function Attrs: argmemonly nofree nosync nounwind willreturn
+declare void @llvm.lifetime.start.p0i8(i64 immarg, i8* nocapture) #2
+
+; Function Attrs: argmemonly nofree nosync nounwind willreturn
+declare void @llvm.lifetime.end.p0i8(i64 immarg, i8* nocapture) #2
+
+define i32 @main() #0 {
+main_block:
+  %y = alloca float, align 4
+  %a = alloca float, align 4
+  %v = alloca [4 x float], align 4
+  %0 = bitcast [4 x float]* %v to i8*
+  call void @llvm.lifetime.start.p0i8(i64 -1, i8* %0)
+  %array_init = getelementptr inbounds [4 x float], [4 x float]* %v, i64 0, i64 0
+  store float 1.000000e+00, float* %array_init, align 4
+  %array_init1 = getelementptr inbounds [4 x float], [4 x float]* %v, i64 0, i64 1
+  store float 2.000000e+00, float* %array_init1, align 4
+  %array_init2 = getelementptr inbounds [4 x float], [4 x float]* %v, i64 0, i64 2
+  store float 3.000000e+00, float* %array_init2, align 4
+  %array_init3 = getelementptr inbounds [4 x float], [4 x float]* %v, i64 0, i64 3
+  store float 4.000000e+00, float* %array_init3, align 4
+  %1 = bitcast float* %a to i8*
+  call void @llvm.lifetime.start.p0i8(i64 -1, i8* %1)
+  store float 2.000000e+00, float* %a, align 4
+  %2 = bitcast float* %y to i8*
+  call void @llvm.lifetime.start.p0i8(i64 -1, i8* %2)
+  store float 1.000000e+00, float* %y, align 4
+  %3 = load float, float* %a, align 4
+  %array_decay = getelementptr inbounds [4 x float], [4 x float]* %v, i64 0, i64 0
+  %call_sum = call float @sum(float* %array_decay, i32 4)
+  %4 = load float, float* %y, align 4
+  %call_axpy = call float @axpy(float %3, float %call_sum, float %4)
+  %f2si_tmp = fptosi float %call_axpy to i32
+  %5 = bitcast float* %y to i8*
+  call void @llvm.lifetime.end.p0i8(i64 -1, i8* %5)
+  %6 = bitcast float* %a to i8*
+  call void @llvm.lifetime.end.p0i8(i64 -1, i8* %6)
+  %7 = bitcast [4 x float]* %v to i8*
+  call void @llvm.lifetime.end.p0i8(i64 -1, i8* %7)
+  ret i32 %f2si_tmp
+}
+
+attributes #0 = { "target-cpu"="generic" }
+attributes #1 = { nofree nosync nounwind readnone speculatable willreturn }
+attributes #2 = { argmemonly nofree nosync nounwind willreturn }
+
+!0 = distinct !{!0, !1}
+!1 = !{!"llvm.loop.mustprogress"}
@@ -0,0 +1,10 @@
+// ncc -run first.c : 'ok' from the host libc, exit code 0
+int putchar(int c);
+
+int main()
+{
+	putchar(111);
+	putchar(107);
+	putchar(10);
+	return 0;
+}
@@ -0,0 +1,21 @@
+// ncc -run -fhot-reload reload.c : prints 'a' every second, change the letter in
+// letter() and save, the loop prints the new one while main keeps counting
+int putchar(int c);
+int sleep(int seconds);
+
+int letter()
+{
+	return 97;
+}
+
+int main()
+{
+	int ticks;
+	for (ticks = 0; ticks < 30; ticks = ticks + 1)
+	{
+		putchar(letter());
+		putchar(10);
+		sleep(1);
+	}
+	return 0;
+}
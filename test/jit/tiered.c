@@ -0,0 +1,21 @@
+// ncc -run -ftiered=100 tiered.c : fib is interpreted for its first 100 calls
+// and loop iterations, then runs natively, main stays interpreted
+int fib(int n)
+{
+	if (n < 2)
+	{
+		return n;
+	}
+	return fib(n - 1) + fib(n - 2);
+}
+
+int main()
+{
+	int i;
+	int sum = 0;
+	for (i = 0; i < 30; i = i + 1)
+	{
+		sum = (sum + fib(i)) % 1000003;
+	}
+	return sum % 256;
+}
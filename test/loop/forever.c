@@ -0,0 +1,26 @@
+// loops left only by 'return', their exit blocks have no predecessors
+int first_square_above(int n)
+{
+	int i = 0;
+	while (1)
+	{
+		if (i * i > n)
+			return i;
+		i = i + 1;
+	}
+}
+
+int count_down(int n)
+{
+	for (;;)
+	{
+		n = n - 1;
+		if (n < 3)
+			return n;
+	}
+}
+
+int main()
+{
+	return first_square_above(50) + count_down(10);
+}
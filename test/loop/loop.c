@@ -0,0 +1,40 @@
+int sum(int n)
+{
+	int s = 0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		if (i == 3)
+			continue;
+		s = s + i;
+	}
+	return s;
+}
+
+int commas(int n)
+{
+	int i;
+	int j;
+	for (i = 0, j = 0; i = i + 1, i < n; j = j + 2, j = j - 1)
+	{
+		j = j + 1;
+	}
+	return j;
+}
+
+int main()
+{
+	int n = 10;
+	int k = 0;
+	while (1)
+	{
+		k = k + 1;
+		if (k > n)
+			break;
+	}
+	do
+	{
+		n = n - 1;
+	} while (n > 0);
+	return sum(k) + n + commas(4);
+}
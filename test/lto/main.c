@@ -0,0 +1,13 @@
+// see square.c
+int square(int x);
+
+int main()
+{
+	int res = 0;
+	int i;
+	for (i = 0; i < 4; i = i + 1)
+	{
+		res = res + square(i);
+	}
+	return res - 14;
+}
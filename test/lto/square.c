@@ -0,0 +1,8 @@
+// ncc -O2 -flto -t=obj main.c square.c -o prog.o, 'square' is inlined into main.c
+// and dropped, only 'main' is left in prog.o. the same with summaries:
+// ncc -O2 -flto=thin -t=bc -j2 main.c square.c
+// ncc -O2 -flto=thin -flto-cache=cache -t=obj main.bc square.bc -o prog.o
+int square(int x)
+{
+	return x * x;
+}
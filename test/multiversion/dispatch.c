@@ -0,0 +1,25 @@
+// ncc dispatch.c -t=ir -O2 -fmultiversion=avx2,avx512f
+// dot is an ifunc over dot.default, dot.avx2 and dot.avx512f, dot.resolver picks by cpuid
+int dot(int n, int *a, int *b)
+{
+	int s = 0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		s = s + a[i] * b[i];
+	}
+	return s;
+}
+
+int main()
+{
+	int a[1024];
+	int b[1024];
+	int i;
+	for (i = 0; i < 1024; i = i + 1)
+	{
+		a[i] = i % 13;
+		b[i] = i % 5;
+	}
+	return dot(1024, a, b) % 256;
+}
@@ -0,0 +1,37 @@
+// ncc -fparallel-codegen=4 -t=obj codegen.c, the parts call 'scale' and 'base'
+// across threads and 'ld -r' merges them back into codegen.o
+int base()
+{
+	return 7;
+}
+
+int scale(int x)
+{
+	return x * 3 + base();
+}
+
+int left(int x)
+{
+	return scale(x) + 1;
+}
+
+int right(int x)
+{
+	return scale(x) - 1;
+}
+
+int sum(int n)
+{
+	int res = 0;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		res = res + left(i) + right(i);
+	}
+	return res;
+}
+
+int main()
+{
+	return sum(10) - 410;
+}
@@ -0,0 +1,31 @@
+// ncc -fparallel-irgen=3 -t=ir irgen.c, the bodies are lowered on three threads
+// against the prototypes of phase one and linked back in source order
+int odd(int n);
+
+int even(int n)
+{
+	if (n == 0)
+	{
+		return 1;
+	}
+	return odd(n - 1);
+}
+
+int odd(int n)
+{
+	if (n == 0)
+	{
+		return 0;
+	}
+	return even(n - 1);
+}
+
+int twice(int x)
+{
+	return x + x;
+}
+
+int main()
+{
+	return even(10) + odd(7) + twice(3) - 8;
+}
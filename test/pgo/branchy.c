@@ -0,0 +1,27 @@
+// ncc branchy.c -t=obj -O2 -fprofile-generate
+// cc branchy.o build/release/libncc_profile.a -o branchy && ./branchy
+// llvm-profdata merge -o branchy.profdata default.profraw
+// ncc branchy.c -t=ir -O2 -fprofile-use=branchy.profdata : branch_weights and function_entry_count
+int classify(int x)
+{
+	if (x % 97 == 0)
+	{
+		return 3;
+	}
+	if (x % 2)
+	{
+		return 1;
+	}
+	return 2;
+}
+
+int main()
+{
+	int i;
+	int sum = 0;
+	for (i = 0; i < 1000000; i = i + 1)
+	{
+		sum = (sum + classify(i)) % 1000003;
+	}
+	return sum % 256;
+}
@@ -0,0 +1,40 @@
+void saxpy(int n, float a, float *restrict x, float *restrict y)
+{
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		y[i] = a * x[i] + y[i];
+	}
+}
+
+// restrict locals, the stores to dst don't clobber src
+void scale(float *buf, int n)
+{
+	float *restrict src = buf;
+	float *restrict dst = buf + n;
+	int i;
+	for (i = 0; i < n; i = i + 1)
+	{
+		dst[i] = src[i] * 2.0;
+	}
+}
+
+int main()
+{
+	float x[1024];
+	float y[1024];
+	float buf[2048];
+	float a = 2.0;
+	int i;
+	for (i = 0; i < 1024; i = i + 1)
+	{
+		x[i] = i;
+		y[i] = 1024 - i;
+	}
+	for (i = 0; i < 10000; i = i + 1)
+	{
+		saxpy(1024, a, x, y);
+	}
+	scale(buf, 1024);
+	return 0;
+}
@@ -0,0 +1,15 @@
+int main(int argc, char const *argv[])
+{
+	int res = 0;
+	if (argc)
+	{
+		int a = 1;
+		res = a;
+	}
+	else
+	{
+		float b = 2.0;
+		res = 2;
+	}
+	return res;
+}
@@ -0,0 +1,14 @@
+int select(int n, int a, int b)
+{
+	int res = a;
+	if (n)
+	{
+		res = b;
+	}
+	return res;
+}
+
+int main()
+{
+	return select(1, 2, 3);
+}
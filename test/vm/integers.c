@@ -0,0 +1,39 @@
+// ncc -vm integers.c : prints '1005', the digits of 5001 backwards, exit code 110 as native;
+// narrow locals wrap on stores, '/' and '%' truncate toward zero
+int putchar(int c);
+
+int collatz(long n)
+{
+	int steps = 0;
+	while (n != 1)
+	{
+		n = n % 2 ? 3 * n + 1 : n / 2;
+		steps++;
+	}
+	return steps;
+}
+int main(int argc, char *argv[])
+{
+	int i, best = 0;
+	unsigned char c = 250;
+	short s = 32767;
+	for (i = 1; i < 10000; ++i)
+	{
+		int n = collatz(i);
+		if (n > best && !(i & 1) || i == 9999)
+			best = n;
+		if (i > 5000)
+			break;
+		else
+			continue;
+	}
+	c += 10;
+	s++;
+	do
+	{
+		putchar('0' + i % 10);
+		i /= 10;
+	} while (i);
+	putchar('\n');
+	return (best + c + (s < 0) + argc * 100 + (-7 / 2) + (-7 % 3) + (1 << 4) + (~0 ^ 3) + (int)(char)300) & 255;
+}